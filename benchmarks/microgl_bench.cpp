@@ -0,0 +1,449 @@
+/*========================================================================================
+ Copyright (2021), Tomer Shalev (tomer.shalev@gmail.com, https://github.com/HendrixString).
+ All Rights Reserved.
+ License is a custom open source semi-permissive license with the following guidelines:
+ 1. unless otherwise stated, derivative work and usage of this file is permitted and
+    should be credited to the project and the author of this project.
+ 2. Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+========================================================================================*/
+/**
+ * headless throughput benchmark of the canvas primitives.
+ *
+ * every primitive is rendered with a fixed scene into a 640x480 canvas for every pixel
+ * coder and canvas options set. a case is first calibrated to a batch of calls, that takes
+ * at least (time-ms), then the batch is timed (repeats) times and the fastest batch is
+ * reported, which is the most reproducible number on a busy machine.
+ *
+ * output is csv on stdout, lines starting with '#' are comments:
+ *   primitive,coder,options,calls,ns_per_call,mpixels_per_s,triangles_per_s
+ * - pixels are the pixels a single call changes, counted once before timing
+ * - triangles are the triangles a single call rasterizes, 0 if not applicable
+ *
+ * usage: microgl_bench [--filter text] [--time-ms ms] [--repeats n]
+ *   --filter   only run cases, whose "primitive,coder,options" contains the text
+ */
+#include <new>
+#include <initializer_list>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <microgl/canvas.h>
+#include <microgl/bitmaps/bitmap.h>
+#include <microgl/pixel_coders/RGB888_PACKED_32.h>
+#include <microgl/pixel_coders/RGBA8888_PACKED_32.h>
+#include <microgl/pixel_coders/RGB565_PACKED_16.h>
+#include <microgl/pixel_coders/RGBA_PACKED.h>
+#include <microgl/samplers/flat_color.h>
+#include <microgl/samplers/texture.h>
+#include <microgl/samplers/mipmap_texture.h>
+#include <microgl/bitmaps/mip_chain.h>
+#include <microgl/math/matrix_4x4.h>
+#include <microgl/shaders/sampler_shader.h>
+#include <microgl/z_buffer.h>
+#include <microgl/camera.h>
+
+#define W 640
+#define H 480
+
+using namespace microgl::sampling;
+using number = float;
+using path_t = microtess::path<number, dynamic_array>;
+
+struct settings_t {
+    const char * filter = nullptr;
+    double time_ms = 10;
+    int repeats = 5;
+} settings;
+
+// deterministic random numbers, so every run renders the same scene
+struct lcg {
+    unsigned int state = 1234567u;
+    unsigned int next() { state = state*1664525u + 1013904223u; return state>>8; }
+    number range(number a, number b) { return a + (b-a)*number(next()&0xffff)/number(0xffff); }
+};
+
+// geometry shared by all the canvases
+struct scene_t {
+    static constexpr int grid = 16, sphere_rings = 16, sphere_segments = 32;
+    static constexpr int sphere_size = (sphere_rings+1)*(sphere_segments+1);
+    static constexpr int sphere_layers = 4;
+    path_t star, polyline;
+    number mesh[4*4*2];
+    // 2d grid of triangles
+    vertex2<number> grid_vertices[(grid+1)*(grid+1)];
+    unsigned grid_indices[grid*grid*6];
+    // 3d sphere
+    vertex3<number> sphere_points[sphere_size];
+    vertex2<number> sphere_uvs[sphere_size];
+    unsigned sphere_indices[sphere_rings*sphere_segments*6];
+    matrix_4x4<number> mvp;
+    // spheres behind each other, for overdraw
+    matrix_4x4<number> layers[sphere_layers];
+    z_buffer<16> depth{W, H};
+    bool font_pixels[16*10*6*16];
+
+    scene_t() {
+        lcg rnd;
+        for (auto & p : font_pixels) p = rnd.next()&1;
+        // star and rectangles with a hole
+        star.linesTo2(150, 150, 450, 150, 200, 450, 300, 50, 400, 450)
+            .closePath()
+            .rect(60, 60, 520, 360)
+            .rect(200, 200, 200, 100, false);
+        polyline.moveTo({20, 20});
+        for (int ix = 1; ix < 40; ++ix)
+            polyline.lineTo({rnd.range(20, W-20), rnd.range(20, H-20)});
+        const number patch[4*4*2] = {
+                40,  40,   200, 20,   380, 20,   600, 40,
+                40,  180,  260, 140,  420, 120,  600, 180,
+                40,  320,  300, 300,  460, 280,  600, 320,
+                40,  440,  200, 460,  380, 460,  600, 440,
+        };
+        for (int ix = 0; ix < 4*4*2; ++ix) mesh[ix] = patch[ix];
+        for (int y = 0; y <= grid; ++y)
+            for (int x = 0; x <= grid; ++x)
+                grid_vertices[y*(grid+1)+x] = {number(20 + x*(W-40)/grid) + rnd.range(-8, 8),
+                                               number(20 + y*(H-40)/grid) + rnd.range(-8, 8)};
+        for (int y = 0, ix = 0; y < grid; ++y)
+            for (int x = 0; x < grid; ++x, ix+=6) {
+                const unsigned a = y*(grid+1)+x, b = a+1, c = a+grid+1, d = c+1;
+                grid_indices[ix+0] = a; grid_indices[ix+1] = b; grid_indices[ix+2] = c;
+                grid_indices[ix+3] = b; grid_indices[ix+4] = d; grid_indices[ix+5] = c;
+            }
+        const number pi = number(3.14159265358979);
+        for (int r = 0; r <= sphere_rings; ++r)
+            for (int s = 0; s <= sphere_segments; ++s) {
+                const number theta = pi*number(r)/sphere_rings, phi = 2*pi*number(s)/sphere_segments;
+                const int ix = r*(sphere_segments+1)+s;
+                sphere_points[ix] = {number(std::sin(theta)*std::cos(phi)), number(std::cos(theta)),
+                                     number(std::sin(theta)*std::sin(phi))};
+                sphere_uvs[ix] = {number(s)/sphere_segments, number(r)/sphere_rings};
+            }
+        for (int r = 0, ix = 0; r < sphere_rings; ++r)
+            for (int s = 0; s < sphere_segments; ++s, ix+=6) {
+                const unsigned a = r*(sphere_segments+1)+s, b = a+1, c = a+sphere_segments+1, d = c+1;
+                sphere_indices[ix+0] = a; sphere_indices[ix+1] = c; sphere_indices[ix+2] = b;
+                sphere_indices[ix+3] = b; sphere_indices[ix+4] = c; sphere_indices[ix+5] = d;
+            }
+        const auto projection = microgl::camera::perspective<number>(
+                microgl::math::deg_to_rad(60.0f), W, H, 1.0f, 100.0f);
+        const auto view = microgl::camera::lookAt<number>({0, 0, 2.2f}, {0, 0, 0}, {0, 1, 0});
+        mvp = projection*view;
+        for (int ix = 0; ix < sphere_layers; ++ix)
+            layers[ix] = mvp*matrix_4x4<number>::translate(0, 0, number(-0.6f*ix));
+    }
+};
+
+/**
+ * the cases of a canvas type, samplers, textures and fonts are of the same
+ * channel bits as the canvas
+ */
+template<typename Canvas>
+struct primitives {
+    using B = blendmode::Normal;
+    using FSO = porterduff::FastSourceOverOnOpaque;
+    using None = porterduff::None<>;
+    using rgba = typename Canvas::rgba;
+    using color_sampler = flat_color<rgba>;
+    using texture_bitmap = typename Canvas::bitmap_t;
+    using texture_t = texture<texture_bitmap, texture_filter::NearestNeighboor>;
+    using mip_chain_t = mip_chain<texture_bitmap>;
+    using mipmap_t = mipmap_texture<mip_chain_t, mip_filter::Nearest>;
+    using trilinear_t = mipmap_texture<mip_chain_t, mip_filter::Trilinear, texture_filter::Bilinear>;
+    using font_bitmap = bitmap<coder::RGBA_PACKED<rgba::r, rgba::g, rgba::b, 8>>;
+    using font_t = microgl::text::bitmap_font<font_bitmap>;
+    using shader_t = sampler_shader<number, texture_t>;
+    using vertex_attributes = typename shader_t::vertex_attributes;
+
+    struct assets_t {
+        texture_bitmap tex_bmp{128, 128};
+        texture_t tex;
+        texture_bitmap photo_bmp{512, 512};
+        texture_t photo;
+        mip_chain_t photo_chain{&photo_bmp};
+        mipmap_t photo_mipmap{&photo_chain};
+        trilinear_t photo_trilinear{&photo_chain};
+        font_bitmap font_bmp{16*10, 6*16};
+        font_t font;
+        microgl::text::layout_cache<> layouts;
+        shader_t shader;
+        vertex_attributes sphere[scene_t::sphere_size];
+
+        explicit assets_t(const scene_t & s) {
+            for (int y = 0; y < 128; ++y)
+                for (int x = 0; x < 128; ++x)
+                    tex_bmp.writeColor(x, y, color(x*2, y*2, ((x>>3)^(y>>3))&1 ? 255 : 40));
+            tex.updateBitmap(&tex_bmp);
+            for (int y = 0; y < 512; ++y)
+                for (int x = 0; x < 512; ++x)
+                    photo_bmp.writeColor(x, y, color((x*y)&255, (x^y)&255, ((x>>2)^(y>>2))&1 ? 255 : 0));
+            photo.updateBitmap(&photo_bmp);
+            photo_chain.update();
+            // a synthetic monospace font of 10x16 glyphs, 16 glyphs a row
+            const color_t white = color(255, 255, 255), clear = {0, 0, 0, 0};
+            for (int ix = 0; ix < font_bmp.width()*font_bmp.height(); ++ix)
+                font_bmp.writeColor(ix, s.font_pixels[ix] ? color_t{white.r, white.g, white.b, 255} : clear);
+            font.bitmap = &font_bmp; font.nativeSize = 16; font.lineHeight = 18;
+            font.width = font_bmp.width(); font.height = font_bmp.height();
+            for (int c = 32; c < 127; ++c) {
+                const int g = c - 32;
+                font.addChar(c, (g%16)*10, (g/16)*16, 10, 16, 0, 0, 11);
+            }
+            for (int ix = 0; ix < scene_t::sphere_size; ++ix) {
+                sphere[ix].point = s.sphere_points[ix];
+                sphere[ix].uv = s.sphere_uvs[ix];
+            }
+            shader.sampler = &tex;
+            shader.matrix = s.mvp;
+        }
+    };
+    struct context { scene_t & scene; assets_t & assets; };
+    using fn = void (*)(Canvas &, context &);
+    struct bench_case { const char * name; fn draw; int triangles; };
+
+    // a color of 8 bit channels in the channel bits of the canvas
+    static color_t color(int r, int g, int b) {
+        return {(channel_t)(r>>(8-rgba::r)), (channel_t)(g>>(8-rgba::g)), (channel_t)(b>>(8-rgba::b)), 255};
+    }
+    static color_sampler flat(int r, int g, int b) { return color_sampler{color(r, g, b)}; }
+
+    static void rect_fill(Canvas & c, context &) {
+        c.template drawRect<B, None, false, number>(flat(40, 120, 200), 10, 10, W-10, H-10);
+    }
+    static void rect_blend(Canvas & c, context &) {
+        c.template drawRect<B, FSO, false, number>(flat(200, 60, 30), 10, 10, W-10, H-10, 128);
+    }
+    static void rect_texture(Canvas & c, context & x) {
+        c.template drawRect<B, FSO, false, number>(x.assets.tex, 10, 10, W-10, H-10);
+    }
+    // a grid of 64x64 thumbnails of a 512x512 bitmap
+    template<typename Sampler>
+    static void rect_thumbnails(Canvas & c, const Sampler & sampler) {
+        for (int y = 0; y + 64 <= H; y += 80)
+            for (int x = 0; x + 64 <= W; x += 80)
+                c.template drawRect<B, None, false, number>(sampler, x, y, x+64, y+64);
+    }
+    static void thumbnails(Canvas & c, context & x) { rect_thumbnails(c, x.assets.photo); }
+    static void thumbnails_mipmap(Canvas & c, context & x) { rect_thumbnails(c, x.assets.photo_mipmap); }
+    static void thumbnails_trilinear(Canvas & c, context & x) { rect_thumbnails(c, x.assets.photo_trilinear); }
+    static void triangle_aa(Canvas & c, context &) {
+        c.template drawTriangle<B, FSO, true, number>(flat(30, 200, 90),
+                20, 30, 0, 0, 620, 90, 1, 0, 250, 460, 0, 1);
+    }
+    static void triangle_texture(Canvas & c, context & x) {
+        c.template drawTriangle<B, FSO, false, number>(x.assets.tex,
+                20, 30, 0, 0, 620, 90, 1, 0, 250, 460, 0, 1);
+    }
+    // a card in the middle of a flip, divides uvs every (1<<span_bits) pixels
+    template<int span_bits>
+    static void quadrilateral_perspective(Canvas & c, context & x) {
+        c.renderingOptions()._2d_raster_bits_perspective_span = span_bits;
+        c.template drawQuadrilateral<B, None, false, number>(x.assets.tex,
+                100, 20, 0, 1, 540, 100, 1, 1, 540, 380, 1, 0, 100, 460, 0, 0);
+        c.renderingOptions()._2d_raster_bits_perspective_span = 0;
+    }
+    static void triangles_mesh(Canvas & c, context & x) {
+        c.template drawTriangles<B, FSO, false, number>(flat(230, 180, 20),
+                matrix_3x3<number>::identity(), x.scene.grid_vertices, (vertex2<number> *)nullptr,
+                x.scene.grid_indices, nullptr, scene_t::grid*scene_t::grid*6,
+                microtess::triangles::indices::TRIANGLES, 200);
+    }
+    static void circle_aa(Canvas & c, context &) {
+        c.template drawCircle<B, FSO, true, number>(flat(250, 80, 160), flat(20, 20, 20),
+                W/2, H/2, 200, 6);
+    }
+    static void pie_aa(Canvas & c, context &) {
+        c.template drawPie<B, FSO, true, number>(flat(250, 160, 40), W/2, H/2, 200, 30, 250);
+    }
+    static void arc_aa(Canvas & c, context &) {
+        c.template drawArc<B, FSO, true, number>(flat(40, 200, 120), W/2, H/2, 200, 40, 30, 250);
+    }
+    static void rounded_rect_aa(Canvas & c, context &) {
+        c.template drawRoundedRect<B, FSO, true, number>(flat(90, 90, 250), flat(20, 20, 20),
+                20, 20, W-20, H-20, 60, 6);
+    }
+    static void path_fill(Canvas & c, context & x) {
+        c.template drawPathFill<B, FSO, true>(flat(250, 40, 40),
+                matrix_3x3<number>::identity(), x.scene.star, microtess::fill_rule::non_zero,
+                microtess::tess_quality::better);
+    }
+    static void path_fill_tessellate(Canvas & c, context & x) {
+        x.scene.star.invalidate();
+        path_fill(c, x);
+    }
+    static void path_fill_scanline(Canvas & c, context & x) {
+        c.template drawPathFill<B, FSO, true>(flat(250, 40, 40),
+                matrix_3x3<number>::identity(), x.scene.star, microtess::fill_rule::non_zero,
+                microtess::tess_quality::better, 255, number(0), number(1), number(1), number(0),
+                Canvas::fill_engine::scanline);
+    }
+    static void path_fill_stencil(Canvas & c, context & x) {
+        c.template drawPathFill<B, FSO, false>(flat(250, 40, 40),
+                matrix_3x3<number>::identity(), x.scene.star, microtess::fill_rule::non_zero,
+                microtess::tess_quality::better, 255, number(0), number(1), number(1), number(0),
+                Canvas::fill_engine::stencil);
+    }
+    static void path_stroke(Canvas & c, context & x) {
+        c.template drawPathStroke<B, FSO, true>(flat(40, 40, 250),
+                matrix_3x3<number>::identity(), x.scene.polyline, number(8),
+                microtess::stroke_cap::round, microtess::stroke_line_join::round,
+                4, std::initializer_list<int>{}, 0);
+    }
+    static void text(Canvas & c, context & x) {
+        microgl::text::text_format format;
+        format.wordWrap = microgl::text::wordWrap::break_word;
+        c.template drawText<false, false, false>(
+                "the quick brown fox jumps over the lazy dog 0123456789 "
+                "THE QUICK BROWN FOX JUMPS OVER THE LAZY DOG !?",
+                x.assets.font, color(250, 250, 250), format, 10, 10, W-10, H-10);
+    }
+    static void text_layout_cache(Canvas & c, context & x) {
+        microgl::text::text_format format;
+        format.wordWrap = microgl::text::wordWrap::break_word;
+        c.template drawText<false, false, false>(
+                "the quick brown fox jumps over the lazy dog 0123456789 "
+                "THE QUICK BROWN FOX JUMPS OVER THE LAZY DOG !?",
+                x.assets.font, color(250, 250, 250), format, x.assets.layouts, 10, 10, W-10, H-10);
+    }
+    static void bezier_patch(Canvas & c, context & x) {
+        c.template drawBezierPatch<microtess::patch_type::BI_CUBIC, B, None, false, false, number, number>(
+                x.assets.tex, matrix_3x3<number>::identity(), x.scene.mesh, 20, 20);
+    }
+    static void triangles_3d(Canvas & c, context & x) {
+        x.scene.depth.clear();
+        c.template drawTriangles<B, None, false, true, true>(x.assets.shader, W, H, x.assets.sphere,
+                x.scene.sphere_indices, scene_t::sphere_rings*scene_t::sphere_segments*6,
+                microtess::triangles::indices::TRIANGLES, microtess::triangles::face_culling::ccw,
+                &x.scene.depth);
+    }
+    template<bool pre_pass>
+    static void triangles_3d_no_culling(Canvas & c, context & x) {
+        x.scene.depth.clear();
+        c.template drawTriangles<B, None, false, true, true, pre_pass>(x.assets.shader, W, H, x.assets.sphere,
+                x.scene.sphere_indices, scene_t::sphere_rings*scene_t::sphere_segments*6,
+                microtess::triangles::indices::TRIANGLES, microtess::triangles::face_culling::none,
+                &x.scene.depth);
+    }
+    static void triangles_3d_overdraw(Canvas & c, context & x) {
+        x.scene.depth.clear();
+        for (int ix = 0; ix < scene_t::sphere_layers; ++ix) { // front to back
+            x.assets.shader.matrix = x.scene.layers[ix];
+            c.template drawTriangles<B, None, false, true, true>(x.assets.shader, W, H, x.assets.sphere,
+                    x.scene.sphere_indices, scene_t::sphere_rings*scene_t::sphere_segments*6,
+                    microtess::triangles::indices::TRIANGLES, microtess::triangles::face_culling::none,
+                    &x.scene.depth);
+        }
+        x.assets.shader.matrix = x.scene.mvp;
+    }
+
+    static int covered_pixels(Canvas & c, context & x, fn draw) {
+        c.clear({0, 0, 0, 255});
+        draw(c, x);
+        color_t color;
+        int count = 0;
+        for (int ix = 0; ix < W*H; ++ix) {
+            c.getPixelColor(ix, color);
+            count += color.r!=0 || color.g!=0 || color.b!=0;
+        }
+        return count;
+    }
+
+    static double time_batch(Canvas & c, context & x, fn draw, long calls) {
+        const auto start = std::chrono::steady_clock::now();
+        for (long ix = 0; ix < calls; ++ix) draw(c, x);
+        const auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::nano>(end - start).count();
+    }
+
+    static void run(const char * coder_name, const char * options_name, scene_t & scene) {
+        static const bench_case cases[] = {
+                {"drawRect/fill", rect_fill, 0},
+                {"drawRect/blend", rect_blend, 0},
+                {"drawRect/texture", rect_texture, 0},
+                {"drawRect/thumbnails", thumbnails, 0},
+                {"drawRect/thumbnails_mipmap", thumbnails_mipmap, 0},
+                {"drawRect/thumbnails_trilinear", thumbnails_trilinear, 0},
+                {"drawTriangle/aa", triangle_aa, 1},
+                {"drawTriangle/texture", triangle_texture, 1},
+                {"drawQuadrilateral/perspective", quadrilateral_perspective<0>, 2},
+                {"drawQuadrilateral/perspective_span_16", quadrilateral_perspective<4>, 2},
+                {"drawTriangles/mesh", triangles_mesh, scene_t::grid*scene_t::grid*2},
+                {"drawCircle/aa", circle_aa, 0},
+                {"drawPie/aa", pie_aa, 0},
+                {"drawArc/aa", arc_aa, 0},
+                {"drawRoundedRect/aa", rounded_rect_aa, 0},
+                {"drawPathFill", path_fill, 0},
+                {"drawPathFill/tessellate", path_fill_tessellate, 0},
+                {"drawPathFill/scanline", path_fill_scanline, 0},
+                {"drawPathFill/stencil", path_fill_stencil, 0},
+                {"drawPathStroke", path_stroke, 0},
+                {"drawText", text, 0},
+                {"drawText/layout_cache", text_layout_cache, 0},
+                {"drawBezierPatch", bezier_patch, 20*20*2},
+                {"drawTriangles/3d_z_buffer", triangles_3d, scene_t::sphere_rings*scene_t::sphere_segments},
+                {"drawTriangles/3d_no_culling", triangles_3d_no_culling<false>,
+                 scene_t::sphere_rings*scene_t::sphere_segments*2},
+                {"drawTriangles/3d_no_culling/pre_pass", triangles_3d_no_culling<true>,
+                 scene_t::sphere_rings*scene_t::sphere_segments*2},
+                {"drawTriangles/3d_overdraw", triangles_3d_overdraw,
+                 scene_t::sphere_layers*scene_t::sphere_rings*scene_t::sphere_segments*2},
+        };
+        char id[128];
+        Canvas * c = nullptr;
+        assets_t * assets = nullptr;
+        for (const auto & test : cases) {
+            snprintf(id, sizeof(id), "%s,%s,%s", test.name, coder_name, options_name);
+            if(settings.filter && !strstr(id, settings.filter)) continue;
+            if(c==nullptr) { c = new Canvas(W, H); assets = new assets_t(scene); }
+            context x{scene, *assets};
+            const int pixels = covered_pixels(*c, x, test.draw);
+            long calls = 1;
+            while (time_batch(*c, x, test.draw, calls) < settings.time_ms*1e6 && calls < (1L<<30))
+                calls *= 2;
+            double best = 0;
+            for (int ix = 0; ix < settings.repeats; ++ix) {
+                const double t = time_batch(*c, x, test.draw, calls);
+                if(ix==0 || t < best) best = t;
+            }
+            const double ns_per_call = best/double(calls);
+            printf("%s,%ld,%.1f,%.2f,%.0f\n", id, calls, ns_per_call,
+                   double(pixels)*1e3/ns_per_call, double(test.triangles)*1e9/ns_per_call);
+            fflush(stdout);
+        }
+        delete c; delete assets;
+    }
+};
+
+template<typename bitmap_type>
+void run_coder(const char * coder_name, scene_t & s) {
+    primitives<canvas<bitmap_type, CANVAS_OPT_32_BIT>>::run(coder_name, "32_BIT", s);
+    primitives<canvas<bitmap_type, CANVAS_OPT_32_BIT_FREE>>::run(coder_name, "32_BIT_FREE", s);
+    primitives<canvas<bitmap_type, CANVAS_OPT_64_BIT>>::run(coder_name, "64_BIT", s);
+    primitives<canvas<bitmap_type, CANVAS_OPT_64_BIT_FREE>>::run(coder_name, "64_BIT_FREE", s);
+    primitives<canvas<bitmap_type, CANVAS_OPT_default | CANVAS_OPT_RASTER_SPANS>>::run(coder_name, "default+RASTER_SPANS", s);
+}
+
+int main(int argc, char ** argv) {
+    for (int ix = 1; ix < argc; ++ix) {
+        if(!strcmp(argv[ix], "--filter") && ix+1 < argc) settings.filter = argv[++ix];
+        else if(!strcmp(argv[ix], "--time-ms") && ix+1 < argc) settings.time_ms = atof(argv[++ix]);
+        else if(!strcmp(argv[ix], "--repeats") && ix+1 < argc) settings.repeats = atoi(argv[++ix]);
+        else {
+            fprintf(stderr, "usage: %s [--filter text] [--time-ms ms] [--repeats n]\n", argv[0]);
+            return 1;
+        }
+    }
+    if(settings.repeats < 1) settings.repeats = 1;
+    static scene_t scene;
+    printf("# microgl_bench canvas %dx%d, fastest of %d batches of at least %.1f ms\n",
+           W, H, settings.repeats, settings.time_ms);
+    printf("primitive,coder,options,calls,ns_per_call,mpixels_per_s,triangles_per_s\n");
+    run_coder<bitmap<coder::RGB888_PACKED_32>>("RGB888_PACKED_32", scene);
+    run_coder<bitmap<coder::RGBA8888_PACKED_32>>("RGBA8888_PACKED_32", scene);
+    run_coder<bitmap<coder::RGB565_PACKED_16>>("RGB565_PACKED_16", scene);
+    return 0;
+}
@@ -0,0 +1,47 @@
+#include "src/example.h"
+#include <microgl/canvas.h>
+#include <microgl/bitmaps/bitmap.h>
+#include <microgl/pixel_coders/RGB888_PACKED_32.h>
+#include <microgl/samplers/linear_gradient_2_colors.h>
+#include <microgl/samplers/flat_color.h>
+
+#define W 640*1
+#define H 640*1
+
+using namespace microgl::sampling;
+using microtess::path;
+
+int main() {
+    using Canvas24= canvas<bitmap<coder::RGB888_PACKED_32>>;
+    using number = float;
+    using path_t = path<number, dynamic_array>;
+
+    linear_gradient_2_colors<120> gradient{{255,0,255}, {255,0,0}};
+    flat_color<> flatColor{{0, 120, 255, 255}};
+    path_t star{};
+    star.linesTo2(150, 150,
+                  450, 150,
+                  200, 450,
+                  300, 50,
+                  400, 450)
+        .closePath();
+
+    Canvas24 canvas(W, H);
+
+    auto render = [&](void*, void*, void*) -> void {
+        canvas.clear({255, 255, 255, 255});
+        // the masks are rasterized once, every draw inside them is only multiplied by them
+        canvas.pushClipRoundedRect<true, number>(50, 50, 590, 590, 120);
+        canvas.pushClipPath(matrix_3x3<number>::identity(), star, microtess::fill_rule::even_odd);
+        canvas.drawRect<blendmode::Normal, porterduff::FastSourceOverOnOpaque, false, number>(
+                gradient, 0, 0, W, H);
+        canvas.popClip();
+        canvas.drawCircle<blendmode::Normal, porterduff::FastSourceOverOnOpaque, true, number>(
+                flatColor, flatColor, 560, 560, 100, 0, 127);
+        canvas.popClip();
+    };
+
+    example_run(&canvas, render);
+
+    return 0;
+}
@@ -0,0 +1,48 @@
+#include "src/Resources.h"
+#include "src/example.h"
+#include <microgl/canvas.h>
+#include <microgl/bitmaps/bitmap.h>
+#include <microgl/pixel_coders/RGB888_PACKED_32.h>
+#include <microgl/pixel_coders/RGBA8888_ARRAY.h>
+#include <microgl/pixel_coders/GRAYSCALE.h>
+#include <microgl/text/sdf_converter.h>
+
+#define TEST_ITERATIONS 100
+#define W 640*1
+#define H 640*1
+
+int main() {
+    using Bitmap24= bitmap<coder::RGB888_PACKED_32>;
+    using Bitmap32_ARRAY= bitmap<coder::RGBA8888_ARRAY>;
+    using BitmapSDF= bitmap<coder::GRAYSCALE<8, 8>>;
+    using Canvas24= canvas<Bitmap24>;
+    using font32= microgl::text::bitmap_font<Bitmap32_ARRAY>;
+    using font_sdf= microgl::text::bitmap_font<BitmapSDF>;
+    using converter= microgl::text::sdf_converter<>;
+
+    Canvas24 canvas(W, H);
+    font32 font = Resources::loadFont<Bitmap32_ARRAY>("minecraft-20");
+    // the distance field is usually converted offline, see mtest_sdf_font_converter
+    const int spread=4, atlas_width=256;
+    font_sdf sdf;
+    sdf.bitmap = new BitmapSDF(atlas_width, converter::atlas_height(font, spread, atlas_width));
+    converter::convert(font, sdf, spread);
+
+    auto render = [&](void*, void*, void*) -> void {
+        text::text_format format;
+        format.wordWrap=text::wordWrap::break_word;
+        canvas.clear({73,84,101,255});
+        int top=0;
+        for (int size : {12, 20, 40, 80}) {
+            format.fontSize=size;
+            canvas.drawText<true, true, false>("micro{gl} distance fields",
+                             sdf, {255, 255, 255, 255}, format,
+                             0, top, W, top+size*2, 255);
+            top+=size+size/2;
+        }
+    };
+
+    example_run(&canvas, render);
+
+    return 0;
+}
@@ -0,0 +1,75 @@
+#include <iostream>
+#include "src/example.h"
+#include "src/Resources.h"
+#include <microgl/tiles/parallel_renderer.h>
+#include <microgl/bitmaps/bitmap.h>
+#include <microgl/pixel_coders/RGB888_PACKED_32.h>
+#include <microgl/pixel_coders/RGB888_ARRAY.h>
+#include <microgl/samplers/texture.h>
+#include <microgl/samplers/flat_color.h>
+
+#define TEST_ITERATIONS 100
+#define W 640*1
+#define H 480*1
+#define TILE_SIZE 64
+// render tiles with all of the hardware threads
+#define PARALLEL 1
+
+using namespace microgl::sampling;
+using namespace microgl::tiles;
+
+int main() {
+    using number = float;
+
+    using Bitmap24= bitmap<coder::RGB888_PACKED_32>;
+    using Canvas24= canvas<Bitmap24>;
+    using Texture24= sampling::texture<Bitmap24, sampling::texture_filter::Bilinear>;
+    Texture24 tex_uv;
+    sampling::flat_color<> color_red{{255,0,0,255}};
+    sampling::flat_color<> color_grey{{122,122,122,255}};
+
+    auto img_2 =Resources::loadImageFromCompressedPath("images/uv_512.png");
+    auto bmp_uv_U8 = new bitmap<coder::RGB888_ARRAY>(img_2.data, img_2.width, img_2.height);
+    tex_uv.updateBitmap(bmp_uv_U8->convertToBitmap<coder::RGB888_PACKED_32>());
+    // the canvas is a single tile, the display list renders the frame through it
+    Canvas24 canvas(TILE_SIZE, TILE_SIZE);
+    display_list<Canvas24> list(W, H);
+    parallel_renderer<Canvas24> renderer_mt(TILE_SIZE, TILE_SIZE);
+    auto * frame = new Canvas24::pixel[W*H];
+    auto * sdl_texture = (SDL_Texture *)nullptr;
+
+    auto render_tiles = [&](SDL_Renderer * renderer) -> void {
+        if(!sdl_texture)
+            sdl_texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGB888,
+                                            SDL_TEXTUREACCESS_STREAMING, W, H);
+        // record
+        list.reset();
+        list.clear({255,255,255,255});
+        list.drawRect<blendmode::Normal, porterduff::None<>, false, number>(tex_uv, 10, 10, 400, 400);
+        list.drawRoundedRect<blendmode::Normal, porterduff::FastSourceOverOnOpaque, true, number>(
+                color_grey, color_red, 300, 200, 600, 450, 50, 10, 200);
+        list.drawCircle<blendmode::Normal, porterduff::FastSourceOverOnOpaque, true, number>(
+                color_red, color_grey, 120, 360, 80, 8);
+        // replay, every tile is copied to the frame buffer once it is done, the parallel
+        // renderer invokes the callback from different threads with disjoint tiles
+        auto copy_tile = [&](Canvas24 & c, const Canvas24::rect & tile) {
+            for (int y = tile.top; y < tile.bottom; ++y)
+                for (int x = tile.left; x < tile.right; ++x)
+                    frame[y*W + x] = c.pixels()[(y-tile.top)*c.width() + (x-tile.left)];
+        };
+        if(PARALLEL) renderer_mt.render(list, copy_tile);
+        else list.render(canvas, copy_tile);
+        SDL_UpdateTexture(sdl_texture, nullptr, frame, W * canvas.sizeofPixel());
+        SDL_RenderClear(renderer);
+        SDL_RenderCopy(renderer, sdl_texture, nullptr, nullptr);
+        SDL_RenderPresent(renderer);
+    };
+
+    auto render = [&](void*, SDL_Renderer * renderer, void*) -> void {
+        render_tiles(renderer);
+    };
+
+    example_run(&canvas, W, H, render, TEST_ITERATIONS, true);
+
+    return 0;
+}
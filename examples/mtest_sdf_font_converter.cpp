@@ -0,0 +1,65 @@
+#include "src/Resources.h"
+#include <microgl/bitmaps/bitmap.h>
+#include <microgl/pixel_coders/RGBA8888_ARRAY.h>
+#include <microgl/pixel_coders/GRAYSCALE.h>
+#include <microgl/text/sdf_converter.h>
+#include <cstdio>
+#include <cctype>
+
+using namespace microgl;
+
+// converts a bitmap font of the assets into a signed distance field font, that is written
+// as a header of its metrics, glyphs and 8 bits atlas.
+// usage: mtest_sdf_font_converter <font> <spread> <atlas width> <output header>
+int main(int argc, char ** argv) {
+    using font32 = microgl::text::bitmap_font<bitmap<coder::RGBA8888_ARRAY>>;
+    using sdf_bitmap = bitmap<coder::GRAYSCALE<8, 8>>;
+    using sdf_font = microgl::text::bitmap_font<sdf_bitmap>;
+    using converter = microgl::text::sdf_converter<>;
+
+    const std::string name = argc>1 ? argv[1] : "minecraft-20";
+    const int spread = argc>2 ? atoi(argv[2]) : 4;
+    const int width = argc>3 ? atoi(argv[3]) : 256;
+    const std::string path = argc>4 ? argv[4] : name + "_sdf.h";
+
+    font32 font = Resources::loadFont<bitmap<coder::RGBA8888_ARRAY>>(name);
+    const int height = converter::atlas_height(font, spread, width);
+    sdf_font sdf;
+    sdf.bitmap = new sdf_bitmap(width, height);
+    if(!converter::convert(font, sdf, spread)) {
+        cout << "the glyphs do not fit an atlas of width " << width << endl;
+        return 1;
+    }
+
+    std::string id = name;
+    for (auto & c : id) if(!isalnum(c)) c = '_';
+    FILE * file = fopen(path.c_str(), "w");
+    if(file==nullptr) {
+        cout << "could not open " << path << endl;
+        return 1;
+    }
+    fprintf(file, "#pragma once\n\n#include <cstdint>\n");
+    fprintf(file, "// %s, signed distance field font, spread %d, %dx%d, 8 bits\n", name.c_str(), spread, width, height);
+    fprintf(file, "// native size, line height, baseline, spread, atlas width, atlas height, glyphs\n");
+    fprintf(file, "const int %s_sdf_font[] = {%d, %d, %d, %d, %d, %d, %d};\n", id.c_str(),
+            sdf.nativeSize, sdf.lineHeight, sdf.baseline, spread, width, height, sdf.charsCount()-1);
+    fprintf(file, "// id, x, y, width, height, x offset, y offset, x advance\n");
+    fprintf(file, "const int %s_sdf_glyphs[][8] = {\n", id.c_str());
+    for (int ix = 1; ix < sdf.charsCount(); ++ix) {
+        const auto & c = sdf.gylphs[ix];
+        fprintf(file, "        {%d, %d, %d, %d, %d, %d, %d, %d},\n", c.id, c.x, c.y, c.width, c.height,
+                c.xOffset, c.yOffset, c.xAdvance);
+    }
+    fprintf(file, "};\n");
+    fprintf(file, "uint8_t %s_sdf_atlas[] = {\n", id.c_str());
+    for (int ix = 0; ix < width*height; ++ix) {
+        color_t color;
+        sdf.bitmap->decode(ix, color);
+        fprintf(file, "%s0x%02x,%s", ix%16==0 ? "        " : " ", color.r, ix%16==15 ? "\n" : "");
+    }
+    fprintf(file, "%s};\n", (width*height)%16 ? "\n" : "");
+    fclose(file);
+    cout << "wrote " << path << ", atlas " << width << "x" << height
+         << " (was " << font.bitmap->width() << "x" << font.bitmap->height() << " RGBA)" << endl;
+    return 0;
+}
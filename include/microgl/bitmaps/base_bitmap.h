@@ -12,6 +12,7 @@
 
 #include "buffer.h"
 #include "../color.h"
+#include "../rect.h"
 #include "../pixel_coders/pixel_coder.h"
 #include "../traits.h"
 #include "../stdint.h"
@@ -36,13 +37,14 @@ public:
     using pixel=typename pixel_coder::pixel;
     using rgba=typename pixel_coder::rgba;
     using allocator_type = Allocator;
+    using rect = microgl::rect_t<int>;
 
 protected:
 
-    int _width = 0, _height = 0;
+    // stride is the distance in pixels between the beginnings of consecutive rows
+    int _width = 0, _height = 0, _stride = 0;
     pixel_coder _coder;
     buffer<buffer_element_type, allocator_type> _buffer;
-    // todo:: add a sub window feature, only involves translating x and y coords or a fixed index ?
 
 public:
     static constexpr bool hasNativeAlphaChannel() { return pixel_coder::rgba::a != 0; }
@@ -50,31 +52,37 @@ public:
     static constexpr int maxNativeAlphaChannelValue() { return (1u<<nativeAlphaChannelBits())-1; }
 
     base_bitmap(int w, int h, const allocator_type & allocator) :
-            _width{w}, _height{h}, _coder{}, _buffer(w*h, allocator) {}
+            _width{w}, _height{h}, _stride{w}, _coder{}, _buffer(w*h, allocator) {}
     base_bitmap(void *$pixels, int w, int h, const allocator_type & allocator) :
-            _width{w}, _height{h}, _coder{},
+            _width{w}, _height{h}, _stride{w}, _coder{},
             _buffer(reinterpret_cast<buffer_element_type *>($pixels), w*h, allocator) {}//base_bitmap($pixels, w*h, w, h, false) {}
     base_bitmap(void *$pixels, int size, int w, int h,
                 const allocator_type & allocator) :
-            _width{w}, _height{h}, _coder{},
+            _width{w}, _height{h}, _stride{w}, _coder{},
+            _buffer(reinterpret_cast<buffer_element_type *>($pixels), size, allocator) {
+    }
+    // rows are (stride) pixels apart
+    base_bitmap(void *$pixels, int size, int w, int h, int stride,
+                const allocator_type & allocator) :
+            _width{w}, _height{h}, _stride{stride}, _coder{},
             _buffer(reinterpret_cast<buffer_element_type *>($pixels), size, allocator) {
     }
 
 
     base_bitmap(const base_bitmap & bmp) : _buffer{bmp._buffer}, _width{bmp.width()},
-                            _height{bmp.height()} {
+                            _height{bmp.height()}, _stride{bmp.stride()} {
     }
     base_bitmap(base_bitmap && bmp) noexcept : _buffer{microgl::traits::move(bmp._buffer)},
-                    _width{bmp.width()}, _height{bmp.height()} {
+                    _width{bmp.width()}, _height{bmp.height()}, _stride{bmp.stride()} {
     }
 
     base_bitmap & operator=(const base_bitmap & bmp) {
-        _width=bmp.width(); _height=bmp.height();
+        _width=bmp.width(); _height=bmp.height(); _stride=bmp.stride();
         _buffer = bmp._buffer;
         return *this;
     }
     base_bitmap & operator=(base_bitmap && bmp) noexcept {
-        _width=bmp.width(); _height=bmp.height();
+        _width=bmp.width(); _height=bmp.height(); _stride=bmp.stride();
         _buffer = microgl::traits::move(bmp._buffer);
         return *this;
     }
@@ -84,16 +92,42 @@ public:
     bool isOwner() const { return _buffer.owner; }
     int width() const { return _width; }
     int height() const { return _height; }
+    // distance in pixels between rows, pixel indices are (y*stride + x)
+    int stride() const { return _stride; }
     int size() const { return _buffer.size();}
+    allocator_type allocator() const { return _buffer.allocator(); }
     const pixel * data() const { return _buffer.data(); }
     pixel * data() { return _buffer.data(); }
 
-    int locate(int x, int y) const { return y*this->_width + x; }
-    pixel pixelAt(int x, int y) const { return this->pixelAt(y*this->_width + x); }
+    int locate(int x, int y) const { return y*this->_stride + x; }
+    pixel pixelAt(int x, int y) const { return this->pixelAt(y*this->_stride + x); }
     pixel pixelAt(int index) const { return this->derived().pixelAt(index); }
-    void writeAt(int x, int y, const pixel &value) { this->writeAt(y*this->_width + x, value); }
+    void writeAt(int x, int y, const pixel &value) { this->writeAt(y*this->_stride + x, value); }
     void writeAt(int index, const pixel &value) { this->derived().writeAt(index, value); }
     void fill(const pixel &value) { this->derived().fill(value); }
+    /**
+     * fill a rectangle with a pixel, the rectangle is right/bottom exclusive and is
+     * clipped to the bitmap. rows, that span the whole stride are filled at once.
+     */
+    void fill_rect(const rect &r, const pixel &value) {
+        const rect c = r.intersect({0, 0, _width, _height});
+        if(c.empty()) return;
+        if(c.width()==_stride) {
+            this->derived().fill_span(c.top*_stride, c.height()*_stride, value);
+            return;
+        }
+        for (int y = c.top, index = c.top*_stride + c.left; y < c.bottom; ++y, index+=_stride)
+            this->derived().fill_span(index, c.width(), value);
+    }
+    // fill the rows [top, bottom) with a pixel
+    void fill_rows(int top, int bottom, const pixel &value) { fill_rect({0, top, _width, bottom}, value); }
+    /**
+     * fill consecutive pixels, bitmaps override it with bulk stores, the default writes
+     * pixel by pixel
+     */
+    void fill_span(int index, int count, const pixel &value) {
+        for (int ix = 0; ix < count; ++ix) writeAt(index + ix, value);
+    }
 
     const pixel_coder &coder() const { return _coder; }
 
@@ -122,7 +156,7 @@ public:
     }
 
     void writeColor(int x, int y, const microgl::color_t &color) {
-        writeColor(y*_width + x, color);
+        writeColor(y*_stride + x, color);
     }
 
     template <typename number>
@@ -134,7 +168,7 @@ public:
 
     template <typename number>
     void writeColor(int x, int y, const microgl::intensity<number> &color) {
-        writeColor<number>(y*_width + x, color);
+        writeColor<number>(y*_stride + x, color);
     }
 
 };
\ No newline at end of file
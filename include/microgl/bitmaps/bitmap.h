@@ -48,14 +48,15 @@ public:
      */
     template<typename CODER2>
     void copyToBitmap(bitmap<CODER2, allocator_type> & bmp) {
-        if(bmp.size()!=this->size()) return;
-        const int size = this->size();
+        if(bmp.width()!=this->width() || bmp.height()!=this->height()) return;
         microgl::color_t color_bmp_1, color_bmp_2;
-        for (int index = 0; index < size; ++index) {
-            this->decode(index, color_bmp_1);
-            microgl::convert_color<typename base::rgba, typename CODER2::rgba>(
-                    color_bmp_1, color_bmp_2);
-            bmp.writeColor(index, color_bmp_2);
+        for (int y = 0; y < this->_height; ++y) {
+            for (int x = 0; x < this->_width; ++x) {
+                this->decode(x, y, color_bmp_1);
+                microgl::convert_color<typename base::rgba, typename CODER2::rgba>(
+                        color_bmp_1, color_bmp_2);
+                bmp.writeColor(x, y, color_bmp_2);
+            }
         }
     }
 
@@ -72,6 +73,16 @@ public:
      * @param h height of bitmap
      */
     bitmap(void *$pixels, int w, int h, const allocator_type & allocator=allocator_type()) : base{$pixels, w, h, allocator} {}
+    /**
+     * create a new bitmap with a given pixel array, that has padding between rows,
+     * for example a frame buffer with a line length bigger than the width
+     * @param $pixels
+     * @param w width of bitmap
+     * @param h height of bitmap
+     * @param stride distance in pixels between the beginnings of rows, stride >= w
+     */
+    bitmap(void *$pixels, int w, int h, int stride, const allocator_type & allocator=allocator_type()) :
+            base{$pixels, h>0 ? (h-1)*stride + w : 0, w, h, stride, allocator} {}
     bitmap(const bitmap & bmp) : base{bmp} {}
     bitmap(bitmap && bmp)  noexcept : base(microgl::traits::move(bmp)) {}
     bitmap & operator=(const bitmap & bmp) {
@@ -86,5 +97,10 @@ public:
 
     pixel pixelAt(int index) const { return this->_buffer[index]; }
     void writeAt(int index, const pixel &value) { this->_buffer.writeAt(value, index); }
-    void fill(const pixel &value) { this->_buffer.fill(value); }
+    void fill(const pixel &value) {
+        // padding between rows might belong to someone else
+        if(this->_stride==this->_width) this->_buffer.fill(value);
+        else this->fill_rect({0, 0, this->_width, this->_height}, value);
+    }
+    void fill_span(int index, int count, const pixel &value) { this->_buffer.fill(value, index, count); }
 };
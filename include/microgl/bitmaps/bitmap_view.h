@@ -0,0 +1,67 @@
+/*========================================================================================
+ Copyright (2021), Tomer Shalev (tomer.shalev@gmail.com, https://github.com/HendrixString).
+ All Rights Reserved.
+ License is a custom open source semi-permissive license with the following guidelines:
+ 1. unless otherwise stated, derivative work and usage of this file is permitted and
+    should be credited to the project and the author of this project.
+ 2. Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+========================================================================================*/
+#pragma once
+
+#include "bitmap.h"
+
+/**
+ * a non owning view of a rectangle of pixels of an existing pixel array, rows of the view
+ * are (stride) pixels apart. a canvas can render into a view of a frame buffer with padded
+ * rows or into a region of an atlas without copying. copies of a view refer to the same
+ * pixels.
+ *
+ * @tparam pixel_coder_ the pixel coder
+ */
+template <typename pixel_coder_, class allocator_type=microgl::traits::std_rebind_allocator<>>
+class bitmap_view : public bitmap<pixel_coder_, allocator_type> {
+    using base=bitmap<pixel_coder_, allocator_type>;
+public:
+    using pixel=typename base::pixel;
+    using rect=typename base::rect;
+
+    /**
+     * view pixels
+     * @param $pixels the first pixel of the view
+     * @param w width of view
+     * @param h height of view
+     * @param stride distance in pixels between the beginnings of rows
+     */
+    bitmap_view(void *$pixels, int w, int h, int stride,
+                const allocator_type & allocator=allocator_type()) :
+            base{$pixels, w, h, stride, allocator} {}
+    /**
+     * view a rectangle of a bitmap, the rectangle is right/bottom exclusive and is
+     * clipped to the bitmap
+     * @param bmp the bitmap, a bitmap or a view with the same pixel coder
+     * @param r the rectangle
+     */
+    template<class bitmap_type>
+    bitmap_view(bitmap_type & bmp, const rect & r, const allocator_type & allocator=allocator_type()) :
+            bitmap_view(bmp, r.intersect({0, 0, bmp.width(), bmp.height()}), allocator, 0) {}
+    bitmap_view(const bitmap_view & view) :
+            base{const_cast<pixel *>(view.data()), view.width(), view.height(), view.stride()} {}
+    bitmap_view(bitmap_view && view) noexcept : base(microgl::traits::move(view)) {}
+    bitmap_view & operator=(const bitmap_view & view) {
+        base::operator=(bitmap_view(view));
+        return *this;
+    }
+    bitmap_view & operator=(bitmap_view && view) noexcept {
+        base::operator=(microgl::traits::move(view));
+        return *this;
+    }
+    ~bitmap_view() = default;
+
+private:
+    template<class bitmap_type>
+    bitmap_view(bitmap_type & bmp, const rect & c, const allocator_type & allocator, int) :
+            base{c.empty() ? bmp.data() : bmp.data() + c.top*bmp.stride() + c.left,
+                 c.empty() ? 0 : c.width(), c.empty() ? 0 : c.height(), bmp.stride(), allocator} {}
+};
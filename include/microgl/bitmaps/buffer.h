@@ -28,8 +28,29 @@ namespace buffer_traits {
     template <class _Tp> inline _Tp&&
     forward(typename remove_reference<_Tp>::type&& __t) noexcept
     { return static_cast<_Tp&&>(__t); }
+
+    template <bool B, class T = void> struct enable_if {};
+    template <class T> struct enable_if<true, T> { typedef T type; };
+
+    // unsigned integers are filled with wide stores of their bytes pattern
+    template<class T> struct is_pattern { static constexpr bool value = false; };
+    template<> struct is_pattern<unsigned char> { static constexpr bool value = true; };
+    template<> struct is_pattern<unsigned short> { static constexpr bool value = true; };
+    template<> struct is_pattern<unsigned int> { static constexpr bool value = true; };
+    template<> struct is_pattern<unsigned long> { static constexpr bool value = true; };
+    template<> struct is_pattern<unsigned long long> { static constexpr bool value = true; };
 }
 
+#if defined(__GNUC__) || defined(__clang__)
+#define buffer_memset(dst, value, size) __builtin_memset((dst), (value), (size))
+#define buffer_store_word(dst, word) __builtin_memcpy((dst), &(word), sizeof(word))
+#else
+#define buffer_memset(dst, value, size) for (unsigned long i_ = 0; i_ < (size); ++i_) \
+                                              ((unsigned char *)(dst))[i_] = (unsigned char)(value)
+#define buffer_store_word(dst, word) for (unsigned i_ = 0; i_ < sizeof(word); ++i_) \
+                                           ((unsigned char *)(dst))[i_] = ((const unsigned char *)&(word))[i_]
+#endif
+
 template<typename element_type, class allocator_type>
 class buffer {
 private:
@@ -106,15 +127,61 @@ public:
         _size=0;
     };
     int size()  const { return _size; }
+    allocator_type allocator() const { return allocator_type(_allocator); }
     element_type & readAt(int index) { return _data[index]; }
     void writeAt(const element_type &value, int index) { _data[index] = value; }
     const element_type &operator[](int index) const { return _data[index]; }
     element_type &operator[](int index) { return _data[index]; }
     element_type * data() { return _data; }
     const element_type * data() const { return _data; }
-    void fill(const element_type &value) {
-        int size2 = _size;
-        for (int ix = 0; ix < size2; ++ix)
-            _data[ix] = value;
+    void fill(const element_type &value) { fill(value, 0, _size); }
+    /**
+     * fill a range of elements. byte uniform values of unsigned integers are filled with
+     * memset, other values are stored as 64 bit words of the repeated pattern
+     *
+     * @param value the value
+     * @param from the first element
+     * @param count number of elements
+     */
+    void fill(const element_type &value, int from, int count) {
+        fill_elements<buffer_traits::is_pattern<element_type>::value>(_data + from, count, value);
+    }
+
+private:
+    template<bool pattern>
+    static typename buffer_traits::enable_if<!pattern>::type
+    fill_elements(element_type * dst, int count, const element_type &value) {
+        for (int ix = 0; ix < count; ++ix)
+            dst[ix] = value;
     }
-};
\ No newline at end of file
+
+    template<bool pattern>
+    static typename buffer_traits::enable_if<pattern>::type
+    fill_elements(element_type * dst, int count, const element_type &value) {
+        using word = unsigned long long;
+        constexpr unsigned size = sizeof(element_type);
+        if(count<=0) return;
+        const auto * bytes = reinterpret_cast<const unsigned char *>(&value);
+        bool uniform = true;
+        for (unsigned ix = 1; ix < size; ++ix) uniform = uniform && bytes[ix]==bytes[0];
+        if(uniform) { buffer_memset(dst, bytes[0], (unsigned long)count * size); return; }
+        // align to a word, elements are aligned to their size, so this always ends
+        while(count && (reinterpret_cast<unsigned long long>(dst) & (sizeof(word)-1))) {
+            *(dst++) = value; --count;
+        }
+        word pattern_word;
+        auto * pattern_bytes = reinterpret_cast<unsigned char *>(&pattern_word);
+        for (unsigned ix = 0; ix < sizeof(word); ++ix) pattern_bytes[ix] = bytes[ix % size];
+        constexpr int per_word = sizeof(word) / size;
+        for (; count >= 2*per_word; count -= 2*per_word, dst += 2*per_word) {
+            buffer_store_word(dst, pattern_word);
+            buffer_store_word(dst + per_word, pattern_word);
+        }
+        for (; count >= per_word; count -= per_word, dst += per_word)
+            buffer_store_word(dst, pattern_word);
+        while(count--) *(dst++) = value;
+    }
+};
+
+#undef buffer_memset
+#undef buffer_store_word
\ No newline at end of file
@@ -0,0 +1,113 @@
+/*========================================================================================
+ Copyright (2021), Tomer Shalev (tomer.shalev@gmail.com, https://github.com/HendrixString).
+ All Rights Reserved.
+ License is a custom open source semi-permissive license with the following guidelines:
+ 1. unless otherwise stated, derivative work and usage of this file is permitted and
+    should be credited to the project and the author of this project.
+ 2. Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+========================================================================================*/
+#pragma once
+
+#include "bitmap.h"
+
+/**
+ * a mip chain of a bitmap, level 0 is the given bitmap and every next level is half the
+ * width and height of the previous level (at least one pixel), down to a 1x1 level. levels
+ * are box filtered from the previous level into regular bitmaps of the same pixel coder,
+ * so any bitmap type can be mip mapped.
+ *
+ * @tparam Bitmap the bitmap type of level 0
+ * @tparam Allocator the allocator of the levels
+ */
+template<class Bitmap, class Allocator=microgl::traits::std_rebind_allocator<>>
+class mip_chain {
+public:
+    using base_type = Bitmap;
+    using pixel_coder = typename Bitmap::pixel_coder;
+    using rgba = typename Bitmap::rgba;
+    using level_type = bitmap<pixel_coder, Allocator>;
+    static constexpr unsigned max_levels = 16;
+
+private:
+    using level_allocator = typename Allocator::template rebind<level_type>::other;
+    Allocator _allocator;
+    level_allocator _level_allocator;
+    Bitmap * _base = nullptr;
+    level_type * _levels[max_levels-1] = {};
+    unsigned _size = 0;
+
+    // average the colors of the boxes of the source, that cover the pixels of the destination
+    template<class Source>
+    static void downsample(const Source & source, level_type & destination) {
+        const int sw = source.width(), sh = source.height();
+        const int dw = destination.width(), dh = destination.height();
+        for (int y = 0; y < dh; ++y) {
+            const int y0 = (y*sh)/dh, y1 = ((y+1)*sh)/dh;
+            for (int x = 0; x < dw; ++x) {
+                const int x0 = (x*sw)/dw, x1 = ((x+1)*sw)/dw;
+                unsigned r=0, g=0, b=0, a=0;
+                microgl::color_t color;
+                for (int yy = y0; yy < y1; ++yy)
+                    for (int xx = x0; xx < x1; ++xx) {
+                        source.decode(xx, yy, color);
+                        r+=color.r; g+=color.g; b+=color.b; a+=color.a;
+                    }
+                const unsigned count = (x1-x0)*(y1-y0), half = count>>1;
+                color.r = (r+half)/count; color.g = (g+half)/count;
+                color.b = (b+half)/count; color.a = (a+half)/count;
+                destination.writeColor(x, y, color);
+            }
+        }
+    }
+
+    void release() {
+        for (unsigned ix = 1; ix < _size; ++ix) {
+            _levels[ix-1]->~level_type();
+            _level_allocator.deallocate(_levels[ix-1], 1);
+            _levels[ix-1] = nullptr;
+        }
+        _size = 0;
+    }
+
+public:
+    /**
+     * build the mip chain of a bitmap
+     * @param base the bitmap of level 0, the chain does not own it
+     * @param allocator the allocator of the levels
+     */
+    explicit mip_chain(Bitmap * base, const Allocator & allocator=Allocator()) :
+            _allocator(allocator), _level_allocator(allocator), _base(base) {
+        update();
+    }
+    mip_chain(const mip_chain &) = delete;
+    mip_chain & operator=(const mip_chain &) = delete;
+    ~mip_chain() { release(); }
+
+    /**
+     * rebuild the levels from level 0, after its pixels or dimensions changed
+     */
+    void update() {
+        release();
+        if(_base==nullptr) return;
+        _size = 1;
+        int w = _base->width(), h = _base->height();
+        while ((w>1 || h>1) && _size<max_levels) {
+            w = w>1 ? w>>1 : 1; h = h>1 ? h>>1 : 1;
+            level_type * level = _level_allocator.allocate(1);
+            _level_allocator.construct(level, w, h, _allocator);
+            if(_size==1) downsample(*_base, *level);
+            else downsample(*_levels[_size-2], *level);
+            _levels[_size++ - 1] = level;
+        }
+    }
+
+    // number of levels, including level 0
+    unsigned levels() const { return _size; }
+    Bitmap & base() const { return *_base; }
+    // a level bigger than 0
+    level_type & level(unsigned index) const { return *_levels[index-1]; }
+    int width(unsigned index) const { return index==0 ? _base->width() : _levels[index-1]->width(); }
+    int height(unsigned index) const { return index==0 ? _base->height() : _levels[index-1]->height(); }
+};
@@ -105,11 +105,27 @@ public:
 
     void fill(const microgl::ints::uint8_t &value) {
         // fast fill
+        this->_buffer.fill(byte_of(value));
+    }
+
+    void fill_span(int index, int count, const microgl::ints::uint8_t &value) {
+        // pixels up to a byte boundary, whole bytes and then the rest
+        constexpr int pixels_per_byte=1<<T;
+        for (; count && (index & (pixels_per_byte-1)); ++index, --count) writeAt(index, value);
+        const int bytes=count>>T;
+        this->_buffer.fill(byte_of(value), index>>T, bytes);
+        index+=bytes<<T; count-=bytes<<T;
+        for (; count; ++index, --count) writeAt(index, value);
+    }
+
+private:
+    // a byte, that all of its pixels have the value
+    static byte byte_of(const microgl::ints::uint8_t &value) {
         byte masked=value&MASK;
         byte byte_rendered=0;
         auto pixels_per_byte=(1u<<T);
         for (unsigned pos = 0; pos < pixels_per_byte; ++pos)
             byte_rendered |= (masked<<(BPP*pos));
-        this->_buffer.fill(byte_rendered);
+        return byte_rendered;
     }
 };
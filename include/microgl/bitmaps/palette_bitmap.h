@@ -142,7 +142,27 @@ public:
 
     void writeAt(int index1, const pixel &value) {
         // warning:: very slow method
-        byte color = locate_index_color_of_pixel_in_palette(value);
+        write_index(index1, locate_index_color_of_pixel_in_palette(value));
+    }
+
+    void fill(const pixel &value) {
+        // fast fill
+        this->_buffer.fill(byte_of(locate_index_color_of_pixel_in_palette(value)));
+    }
+
+    void fill_span(int index, int count, const pixel &value) {
+        // the palette is searched once, pixels up to a byte boundary, whole bytes and then the rest
+        const byte color = locate_index_color_of_pixel_in_palette(value);
+        constexpr int pixels_per_byte=1<<T;
+        for (; count && (index & (pixels_per_byte-1)); ++index, --count) write_index(index, color);
+        const int bytes=count>>T;
+        this->_buffer.fill(byte_of(color), index>>T, bytes);
+        index+=bytes<<T; count-=bytes<<T;
+        for (; count; ++index, --count) write_index(index, color);
+    }
+
+private:
+    void write_index(int index1, byte color) {
         byte mm=M, kk=K, tt=T, mask=MASK; // debug
         byte masked_value=color&MASK; // mask the value, this is redundant
         byte clear_mask=MASK; // to clear
@@ -158,13 +178,13 @@ public:
         this->_buffer[idx2] = element; // record
     }
 
-    void fill(const pixel &value) {
-        // fast fill
-        byte masked=locate_index_color_of_pixel_in_palette(value);
+    // a byte, that all of its pixels have the palette index
+    static byte byte_of(byte color) {
+        byte masked=color&MASK;
         byte byte_rendered=0;
         auto pixels_per_byte=(1u<<T);
         for (unsigned pos = 0; pos < pixels_per_byte; ++pos)
             byte_rendered |= (masked<<(BPI * pos));
-        this->_buffer.fill(byte_rendered);
+        return byte_rendered;
     }
 };
@@ -11,6 +11,9 @@
 #pragma once
 
 #include "rect.h"
+#include "damage_region.h"
+#include "stencil_buffer.h"
+#include "clip_mask.h"
 #include "color.h"
 #include "traits.h"
 #include "masks.h"
@@ -19,13 +22,21 @@
 #include "math/vertex2.h"
 #include "math/matrix_3x3.h"
 #include "pixel_coders/pixel_coder.h"
+#include "pixel_coders/SINGLE.h"
+#include "bitmaps/bitmap.h"
 #include "porter_duff/FastSourceOverOnOpaque.h"
 #include "porter_duff/DestinationIn.h"
 #include "porter_duff/None.h"
+#include "porter_duff/SourceOver.h"
+#include "porter_duff/porter_duff_traits.h"
 #include "blend_modes/Normal.h"
 #include "shaders/shader.h"
 #include "samplers/texture.h"
+#include "samplers/sdf_texture.h"
 #include "samplers/void_sampler.h"
+#include "samplers/flat_color.h"
+#include "samplers/sampler.h"
+#include "kernels/blend_span.h"
 #ifndef MICROGL_USE_EXTERNAL_MICRO_TESS
 #include "micro-tess/include/micro-tess/triangles.h"
 #include "micro-tess/include/micro-tess/polygons.h"
@@ -52,6 +63,7 @@
 #include "clippers/cohen_sutherland_clipper.h"
 #include "clippers/homo_triangle_clipper.h"
 #include "text/bitmap_font.h"
+#include "text/layout_cache.h"
 
 using namespace microtess::triangles;
 using namespace microtess::polygons;
@@ -90,6 +102,18 @@ using namespace microgl;
  * where overflows are likely to happen
  */
 #define CANVAS_OPT_AVOID_RENDER_WITH_OVERFLOWS microgl::ints::uint8_t(0b00000100)
+/**
+ * walk triangles by spans. every row of the bounding box is first clipped by the edge
+ * functions to the exact range of covered pixels (plus the anti-alias fringe), so pixels
+ * outside the triangle are never tested. thin and diagonal triangles, such as strokes and
+ * slivers of tessellated paths, benefit the most. costs a few divisions per row.
+ * big triangles are rasterized in blocks, the rows of blocks, that are partially
+ * covered by a triangle without anti-aliasing, are clipped the same way.
+ * the clipped rows are sampled as spans by span samplers (see sampleSpan), whose uvs
+ * are interpolated and may be off by one unit, so textures may differ by a texel from
+ * rendering without this flag.
+ */
+#define CANVAS_OPT_RASTER_SPANS microgl::ints::uint8_t(0b00010000)
 /**
  * use a true 32 bit mode in the 2d and 3d rasterizer, this means regular 32 bit integers
  * and also the usage of division in order to reduce overflow and also detecting
@@ -139,11 +163,28 @@ public:
     using index = unsigned int;
     using precision = unsigned char;
     using opacity_t = unsigned char;
+    // the damage region keeps at most 8 rectangles
+    using damage_region_t = microgl::damage_region<8>;
 
     static constexpr bool options_compress_bits() { return options & CANVAS_OPT_COMPRESS_BITS; }
     static constexpr bool options_big_integers() { return options & CANVAS_OPT_USE_BIG_INT; }
     static constexpr bool options_avoid_overflow() { return options & CANVAS_OPT_AVOID_RENDER_WITH_OVERFLOWS; }
     static constexpr bool options_use_division() { return options & CANVAS_OPT_USE_DIVISION; }
+    static constexpr bool options_raster_spans() { return options & CANVAS_OPT_RASTER_SPANS; }
+    // max pixels of a span, that are sampled at once into a colors buffer on the stack
+    static constexpr int span_chunk() { return 64; }
+    // entries of the cache of shaded vertices of drawTriangles with shaders, a power of 2
+    static constexpr int vertex_cache_size() { return 64; }
+    // max vertices of the 2D drawTriangles, that are transformed into a scratch buffer on the stack,
+    // the vertices of bigger meshes go into a buffer of the allocator
+    static constexpr int vertex_stage_stack_size() { return 16; }
+    // half extent of the guard band of 3d triangles in normalized device coordinates, triangles inside
+    // it are not clipped. 32 bit rasterization has no integer bits to spare beyond the viewport
+    static constexpr int guard_band() { return options_big_integers() ? 4 : 1; }
+    // max cells of the coverage buffer of the scanline path filler, rows are filled in bands
+    static constexpr int path_fill_cells() { return 1<<14; }
+    // max depth of the stack of clip masks
+    static constexpr int clip_depth() { return 4; }
     static constexpr bool hasNativeAlphaChannel() { return pixel_coder::rgba::a != 0;}
 
     // rasterizer integers
@@ -158,8 +199,27 @@ public:
         microgl::ints::uint8_t _2d_raster_bits_uv= options_big_integers() ? 15 : 10;
         microgl::ints::uint8_t _3d_raster_bits_sub_pixel= options_big_integers() ? 8 : 4;
         microgl::ints::uint8_t _3d_raster_bits_w= options_big_integers() ? 15 : 12;
+        // perspective correct triangles and quadrilaterals divide uvs exactly every (1<<bits) pixels
+        // of a row and interpolate them linearly in between, 0 divides every pixel. a pixel is off
+        // by at most (sqrt(r)-1)/(sqrt(r)+1) of the uv delta of its span, where r is the ratio of
+        // the q of the span ends, i.e. less than 2.4% of the delta if q changes by 10% along it
+        microgl::ints::uint8_t _2d_raster_bits_perspective_span= 0;
     };
 
+    /**
+     * the engine of path fills:
+     * - tessellation: tessellate the path into triangles, which are cached by the path
+     * - scanline: rasterize the flattened path directly into a coverage buffer, better
+     *   for complex paths, that change every frame
+     * - stencil: count the winding of the pixels with triangle fans of the sub-paths in a
+     *   stencil buffer, then cover the pixels, that pass the fill rule, not anti-aliased
+     */
+    enum class fill_engine { tessellation, scanline, stencil };
+
+    // the 8 bit coverage of a clip and the canvas, that rasterizes it, see pushClip()
+    using clip_mask_t = microgl::clip_mask<typename bitmap_type::allocator_type>;
+    using mask_canvas_t = canvas<bitmap<coder::A<8>, typename bitmap_type::allocator_type>, options>;
+
     struct window_t {
         rect canvas_rect;
         rect clip_rect;
@@ -170,16 +230,34 @@ private:
     bitmap_type _bitmap_canvas;
     window_t _window;
     render_options_t _options;
+    damage_region_t _damage;
+    // the top mask is the intersection of all the pushed masks
+    clip_mask_t _clips[clip_depth()];
+    int _clip_count=0;
+
+    void copyClips(const canvas & val) {
+        for (int ix = 0; ix < val._clip_count; ++ix) _clips[ix].assign(val._clips[ix]);
+        _clip_count = val._clip_count;
+    }
+
+
+    // the clip masks allocate with the allocator of the bitmap
+    void updateClipsAllocator() {
+        const typename bitmap_type::allocator_type allocator = _bitmap_canvas.allocator();
+        for (int ix = 0; ix < clip_depth(); ++ix) _clips[ix].updateAllocator(allocator);
+    }
 
 public:
     explicit canvas(bitmap_type && $bmp) : _bitmap_canvas(microgl::traits::move($bmp)) {
-        updateClipRect(0, 0, $bmp.width(), $bmp.height());
+        updateClipRect(0, 0, _bitmap_canvas.width(), _bitmap_canvas.height());
         updateCanvasWindow(0, 0);
+        updateClipsAllocator();
     }
 
     explicit canvas(const bitmap_type & $bmp) : _bitmap_canvas($bmp) {
         updateClipRect(0, 0, $bmp.width(), $bmp.height());
         updateCanvasWindow(0, 0);
+        updateClipsAllocator();
     }
 
     canvas(int width, int height,
@@ -187,8 +265,27 @@ public:
            _bitmap_canvas(width, height, allocator) {
         updateClipRect(0, 0, width, height);
         updateCanvasWindow(0, 0);
+        updateClipsAllocator();
     }
 
+    // copies own a copy of the clip stack
+    canvas(const canvas & val) : _bitmap_canvas(val._bitmap_canvas), _window(val._window),
+                                 _options(val._options), _damage(val._damage) {
+        updateClipsAllocator();
+        copyClips(val);
+    }
+    canvas(canvas && val) noexcept = default;
+
+    canvas & operator=(const canvas & val) {
+        if(&val==this) return *this;
+        _bitmap_canvas = val._bitmap_canvas; _window = val._window;
+        _options = val._options; _damage = val._damage;
+        updateClipsAllocator();
+        copyClips(val);
+        return *this;
+    }
+    canvas & operator=(canvas && val) noexcept = default;
+
     /**
      * update the clipping rectangle of the canvas
      *
@@ -213,7 +310,7 @@ public:
      */
     void updateCanvasWindow(int left, int top, int right, int bottom) {
         _window.canvas_rect = {left, top, left + right, top + bottom };
-        _window.index_correction= _window.canvas_rect.width()*_window.canvas_rect.top
+        _window.index_correction= _bitmap_canvas.stride()*_window.canvas_rect.top
                                   + _window.canvas_rect.left;
         if(_window.clip_rect.empty())
             _window.clip_rect= _window.canvas_rect;
@@ -231,6 +328,7 @@ public:
      */
     rect calculateEffectiveDrawRect() {
         rect r = _window.canvas_rect.intersect(_window.clip_rect);
+        if(_clip_count) r = r.intersect(_clips[_clip_count-1].bounds());
         r.bottom-=1;r.right-=1;
         return r;
     }
@@ -269,6 +367,113 @@ public:
         return _options;
     }
 
+    /**
+     * get the damage region, the areas the canvas drew into since the last
+     * clearDamage(). every draw call adds its bounding box clipped to the canvas
+     * window and clip rect, so a presenter can upload only these rectangles (or the
+     * rows they span) to the display. rectangles are in canvas coordinates and are
+     * right/bottom exclusive. pixel level writes (drawPixel, blendColor) are not tracked.
+     *
+     * @return the damage region
+     */
+    const damage_region_t & damage() const {
+        return _damage;
+    }
+
+    /**
+     * empty the damage region, usually after the presenter flushed it
+     */
+    void clearDamage() {
+        _damage.clear();
+    }
+
+    /**
+     * mark a rectangle as damaged without drawing, for example where a moved object
+     * was, so it will be redrawn by redrawDamage() and flushed
+     *
+     * @param l left distance to x=0
+     * @param t top distance to y=0
+     * @param r right distance to x=0
+     * @param b bottom distance to y=0
+     */
+    void invalidate(int l, int t, int r, int b) {
+        _damage.add(rect{l, t, r, b}.intersect(_window.canvas_rect));
+    }
+
+    /**
+     * redraw only within the damage, the render function is called once for every
+     * rectangle of the damage region, while the clip rect is the intersection of the
+     * rectangle and the current clip rect. draw calls outside of it are rejected early.
+     *
+     * @tparam render_function a callable with signature void(canvas &)
+     * @param render the render function, draws the scene
+     */
+    template<typename render_function>
+    void redrawDamage(const render_function & render) {
+        const damage_region_t region = _damage;
+        const rect old = clipRect();
+        for (const auto & r : region) {
+            const rect c = r.intersect(old);
+            if(c.empty()) continue;
+            updateClipRect(c.left, c.top, c.right, c.bottom);
+            render(*this);
+        }
+        updateClipRect(old.left, old.top, old.right, old.bottom);
+    }
+
+    /**
+     * push a clip mask, the coverage of every blended pixel is multiplied by it until it is
+     * popped. the render function draws the coverage of the clip with any alpha sampler into
+     * a mask canvas, that covers a rectangle of the canvas and has the same coordinates,
+     * the coverage is rasterized once into an 8 bit buffer over the rows of the rectangle
+     * with the stride of the bitmap, and pixels outside of it are clipped. a mask is
+     * intersected with the mask below it and belongs to the window it was pushed in.
+     *
+     * @tparam render_function a callable with signature void(mask_canvas_t &)
+     * @param l left distance to x=0
+     * @param t top distance to y=0
+     * @param r right distance to x=0
+     * @param b bottom distance to y=0
+     * @param render the render function, draws the coverage
+     *
+     * @return false if the stack is full (clip_depth()), the clip is not pushed
+     */
+    template<typename render_function>
+    bool pushClip(int l, int t, int r, int b, const render_function & render);
+
+    /**
+     * push a clip mask of a rounded rectangle, for example to clip the rows of a scrolling
+     * list to rounded corners, see pushClip()
+     */
+    template<bool antialias=true, typename number>
+    bool pushClipRoundedRect(const number & left, const number & top,
+                             const number & right, const number & bottom,
+                             const number & radius);
+
+    /**
+     * push a clip mask of a path, that is filled with the scanline engine, see pushClip()
+     */
+    template<typename number, template<typename...> class path_container_template,
+            class tessellation_allocator>
+    bool pushClipPath(const matrix_3x3<number> &transform,
+                      microtess::path<number, path_container_template, tessellation_allocator> &path,
+                      const microtess::fill_rule &rule=microtess::fill_rule::non_zero);
+
+    /**
+     * pop the top clip mask
+     */
+    void popClip() { if(_clip_count) _clip_count--; }
+
+    /**
+     * the number of pushed clip masks
+     */
+    int clipDepth() const { return _clip_count; }
+
+    /**
+     * the top clip mask, the intersection of the pushed masks, or null if there is none
+     */
+    const clip_mask_t * clipMask() const { return _clip_count ? &_clips[_clip_count-1] : nullptr; }
+
     // get canvas width
     int width() const;
     // get canvas height
@@ -332,8 +537,42 @@ public:
     template<typename BlendMode=blendmode::Normal,
             typename PorterDuff=porterduff::FastSourceOverOnOpaque,
             microgl::ints::uint8_t a_src>
-//    __attribute__((noinline))
     static void blendColor(const color_t &val, int index, opacity_t opacity, canvas & canva) {
+        if(canva._clip_count) {
+            opacity = canva.clipOpacity(index, opacity);
+            if(opacity==0) return;
+        }
+        blendColorUnmasked<BlendMode, PorterDuff, a_src>(val, index, opacity, canva);
+    }
+
+private:
+    /**
+     * the offset of a pixel in the memory of the top clip mask, whose rows have the stride
+     * of the bitmap
+     *
+     * @param index canvas space index of the pixel
+     */
+    int clipOffset(int index) const {
+        const clip_mask_t & mask = _clips[_clip_count-1];
+        return index - mask.bounds().top*_bitmap_canvas.stride() - mask.left();
+    }
+
+    /**
+     * the opacity of a pixel multiplied by the coverage of the top clip mask
+     *
+     * @param index canvas space index of the pixel
+     */
+    opacity_t clipOpacity(int index, opacity_t opacity) const {
+        const int coverage = _clips[_clip_count-1].at(clipOffset(index));
+        return opacity_t((int(opacity)*coverage*257 + 257)>>16);
+    }
+
+    /**
+     * blend a color like blendColor, ignoring the clip mask
+     */
+    template<typename BlendMode, typename PorterDuff, microgl::ints::uint8_t a_src>
+//    __attribute__((noinline))
+    static void blendColorUnmasked(const color_t &val, int index, opacity_t opacity, canvas & canva) {
         // correct index position when window is not at the (0,0) costs one subtraction.
         // we use it for sampling the backdrop if needed and for writing the output pixel
         index -= canva._window.index_correction;
@@ -356,11 +595,12 @@ public:
         static_assert(src_a_bits==canvas_a_bits, "src_a_bits!=canvas_a_bits");
 
         const color_t & src = val;
-        static color_t result{};
+        // locals and not statics, so different canvases can blend from different threads
+        color_t result{};
 
         if(!skip_all) {
             pixel output;
-            static color_t backdrop{}, blended{};
+            color_t backdrop{}, blended{};
             // normal blend and none composite do not require a backdrop
             if(!(skip_blending && none_compositing))
                 canva._bitmap_canvas.decode(index, backdrop); // not using getPixelColor to avoid extra subtraction
@@ -416,6 +656,67 @@ public:
             canva._bitmap_canvas.writeAt(index, output);
         }
     }
+
+public:
+    /**
+     * blend a span of colors into consecutive pixels of a row. regular bitmaps of the
+     * RGB888_PACKED_32, RGBA8888_PACKED_32 and RGB565_PACKED_16 coders with normal blending and
+     * None/SourceOver/FastSourceOverOnOpaque compositing are blended with vector kernels,
+     * the result is the same as blending pixel by pixel with blendColor.
+     *
+     * @tparam BlendMode the blend mode
+     * @tparam PorterDuff the alpha compositing mode
+     * @tparam a_src alpha bits of the colors
+     *
+     * @param colors the colors of the span
+     * @param coverage per pixel opacity, or nullptr to use the opacity for all pixels
+     * @param opacity uniform opacity
+     * @param index canvas space index of the first pixel
+     * @param count number of pixels
+     * @param canva the canvas
+     */
+    template<typename BlendMode=blendmode::Normal,
+            typename PorterDuff=porterduff::FastSourceOverOnOpaque,
+            microgl::ints::uint8_t a_src>
+    static void blendSpan(const color_t * colors, const opacity_t * coverage, opacity_t opacity,
+                          int index, int count, canvas & canva) {
+        using kernel = kernels::blend_span<bitmap_type, BlendMode, PorterDuff, a_src>;
+        if(canva._clip_count) {
+            // the span is a run of a row of the mask, which is outside of the mask or all in it
+            const clip_mask_t & mask = canva._clips[canva._clip_count-1];
+            const int offset = canva.clipOffset(index);
+            if(unsigned(offset)>=unsigned(mask.size())) return;
+            const typename clip_mask_t::value_type * cover = mask.data() + offset;
+            const int i = index - canva._window.index_correction;
+            opacity_t masked[span_chunk()];
+            for (int k = 0; k < count; k+=span_chunk()) {
+                const int n = count-k < span_chunk() ? count-k : span_chunk();
+                for (int j = 0; j < n; ++j)
+                    masked[j] = opacity_t((int(coverage ? coverage[k+j] : opacity)*
+                                           cover[k+j]*257 + 257)>>16);
+                // runs of covered pixels, clipped pixels are left as they are
+                for (int from = 0, to; from < n; from = to) {
+                    if(masked[from]==0) { to = from+1; continue; }
+                    for (to = from+1; to < n && masked[to]; ++to);
+                    int ix = from;
+                    if(kernel::supported)
+                        ix += int(kernel::blend(canva._bitmap_canvas.data() + i+k+from, colors+k+from,
+                                                masked+from, 255, to-from));
+                    for (; ix < to; ++ix)
+                        blendColorUnmasked<BlendMode, PorterDuff, a_src>(colors[k+ix], index+k+ix, masked[ix], canva);
+                }
+            }
+            return;
+        }
+        int ix = 0;
+        if(kernel::supported)
+            ix = int(kernel::blend(canva._bitmap_canvas.data() + index - canva._window.index_correction,
+                                   colors, coverage, opacity, count));
+        for (; ix < count; ++ix)
+            blendColorUnmasked<BlendMode, PorterDuff, a_src>(colors[ix], index + ix,
+                                                             coverage ? coverage[ix] : opacity, canva);
+    }
+
     /**
      * draw an already encoded pixel at position
      */
@@ -793,6 +1094,7 @@ public:
      * @tparam number2          number type of uv coords
      * @tparam Sampler1         sampler type for fill
      * @tparam Sampler2         sampler type for stroke
+     * @tparam Allocator        allocator of the scratch buffer of the transformed vertices
      *
      * @param sampler           fill sampler reference
      * @param transform         3x3 matrix transformation
@@ -807,9 +1109,14 @@ public:
      * @param v0                uv coord
      * @param u1                uv coord
      * @param v1                uv coord
+     * @param allocator         (Optional) allocator of the scratch buffer, every vertex is transformed
+     *                          and converted to fixed point once into it, so shared vertices of
+     *                          fans, strips and indexed triangles are not transformed again.
+     *                          meshes of up to vertex_stage_stack_size() vertices use the stack
      */
     template<typename BlendMode=blendmode::Normal, typename PorterDuff=porterduff::FastSourceOverOnOpaque,
-            bool antialias=false, typename number1=float, typename number2=float, typename Sampler>
+            bool antialias=false, typename number1=float, typename number2=float, typename Sampler,
+            class Allocator=microgl::traits::std_rebind_allocator<>>
     void drawTriangles(const Sampler & sampler,
                        const matrix_3x3<number1> &transform,
                        const vertex2<number1> *vertices= nullptr,
@@ -820,7 +1127,8 @@ public:
                        enum indices type=indices::TRIANGLES,
                        opacity_t opacity=255,
                        const number2 &u0=number2(0), const number2 &v0=number2(1),
-                       const number2 &u1=number2(1), const number2 &v1=number2(0));
+                       const number2 &u1=number2(1), const number2 &v1=number2(0),
+                       const Allocator & allocator=Allocator());
 
     /**
      * Draw 3d triangle batches. Given:
@@ -835,11 +1143,18 @@ public:
      * Indices array point to the vertex array and is an important concept, when you want
      * to draw a subset of vertices, or to construct triangles from a set of vertices
      *
+     * varying, that describe their layout (see shading::varying_layout), are interpolated
+     * incrementally along rows with floating point shader numbers, see drawTriangle.
+     *
      * @tparam BlendMode            the blend mode struct
      * @tparam PorterDuff           the alpha compositing struct
      * @tparam antialias            enable/disable anti-aliasing, currently NOT supported
      * @tparam perspective_correct  enable/disable z-correction
      * @tparam depth_buffer_flag    enable/disable z-buffer
+     * @tparam depth_pre_pass       with z-buffer, first write the depths of all of the triangles and then
+     *                              shade only the fragments, that are at the written depth, so every pixel
+     *                              runs the fragment shader once (or once per fragment of the same nearest
+     *                              depth), at the cost of running the vertex shader and clipping twice
      * @tparam Shader               the type of the shader
      * @tparam depth_buffer_type    The type of the z-buffer
      *
@@ -858,7 +1173,7 @@ public:
      */
     template<typename BlendMode=blendmode::Normal, typename PorterDuff=porterduff::FastSourceOverOnOpaque,
             bool antialias, bool perspective_correct, bool depth_buffer_flag=false,
-            typename Shader, typename depth_buffer_type >
+            bool depth_pre_pass=false, typename Shader, typename depth_buffer_type >
     void drawTriangles(Shader &shader,
                        int viewport_width, int viewport_height,
                        const vertex_attributes<Shader> *vertex_buffer,
@@ -934,6 +1249,105 @@ private:
                                precision uv_precision, bool aa_first_edge = true,
                                bool aa_second_edge = true, bool aa_third_edge = true);
 
+    /**
+     * narrow the span [from, to] of pixel offsets in a row to the offsets k, for which
+     * the edge function (w + A*k) >= threshold, used by span rasterization
+     */
+    static void clipSpanToEdge(rint_big w, rint_big A, rint_big threshold, int & from, int & to);
+
+    /**
+     * the minimum and maximum of the edge function (w + A*x + B*y) over a block of
+     * pixels of size (width x height), the extremes of a linear function are at the corners
+     */
+    static void edgeBlockBounds(rint_big w, rint_big A, rint_big B, int width, int height,
+                                rint_big & min, rint_big & max);
+
+    /**
+     * the biggest offset d from the center of a disk, for which ((d*d)>>p) <= range, or -1 if
+     * there is none. the extent of the part of a disk in a row, which is closer than a squared
+     * distance to its center, is the offset for a range of that distance minus the row term
+     */
+    static rint_big diskExtent(rint_big range, precision p);
+
+    /**
+     * narrow the offsets [lo, hi] of a row to the offsets x, for which k*x >= c. a test, that
+     * is linear in x, keeps a half of the row
+     */
+    static void narrowRow(rint_big k, rint_big c, rint_big & lo, rint_big & hi);
+
+    /**
+     * sorted and disjoint spans of pixels of a row, that are added from left to right,
+     * adjacent spans are merged
+     */
+    struct row_spans {
+        int from[4], to[4], count=0;
+        /**
+         * add the pixels [a, b]
+         */
+        void add(int a, int b) {
+            if(a>b) return;
+            if(count && to[count-1]+1>=a) { if(b>to[count-1]) to[count-1]=b; return; }
+            from[count]=a; to[count]=b; ++count;
+        }
+        /**
+         * add the pixels, whose sub pixel x is in [lo, hi], clipped to [left, right]
+         */
+        void add(rint_big lo, rint_big hi, precision p, int left, int right) {
+            const rint_big f = -((-lo)>>p), t = hi>>p;
+            if(f>right || t<left) return;
+            add(f<left ? left : int(f), t>right ? right : int(t));
+        }
+        /**
+         * the pixels, that are in both spans, at most four pieces
+         */
+        row_spans intersect(const row_spans & other) const {
+            row_spans result;
+            for (int i = 0; i < count; ++i)
+                for (int j = 0; j < other.count; ++j)
+                    result.add(from[i]>other.from[j] ? from[i] : other.from[j],
+                               to[i]<other.to[j] ? to[i] : other.to[j]);
+            return result;
+        }
+    };
+
+    /**
+     * blend (count) pixels of a row, that are sampled at uvs (see sampleSpan), at an opacity.
+     * flat colors, that composite to the same pixel, are filled with that pixel
+     *
+     * @param from offset of the first pixel for uv
+     * @param index canvas space index of the first pixel
+     */
+    template<typename BlendMode, typename PorterDuff, typename Sampler, typename uv_function>
+    void blendSampledSpan(const Sampler & sampler, const uv_function & uv, int from, int count,
+                          int index, precision uv_precision, opacity_t opacity);
+
+    /**
+     * sample (count) pixels of a row into output. uv is a callable of the form
+     * void(int k, int & u, int & v), that computes the exact uv of the k-th pixel.
+     * span samplers get the uvs of the ends and interpolate linearly in between,
+     * other samplers are sampled pixel by pixel with the exact uvs. the interpolated
+     * uvs are off the exact uvs by up to one unit, so span samplers are not bit exact
+     * with sampling pixel by pixel.
+     */
+    template<typename Sampler, typename uv_function>
+    static void sampleSpan(const Sampler & sampler, const uv_function & uv, int from, int count,
+                           precision uv_precision, color_t * output);
+    /**
+     * the uv footprint of the pixels of a triangle, that is the uv deltas of a step of one pixel
+     * in x and in y, samplers with levels of detail pick their levels by it (sampling::has_levels)
+     */
+    static void uvFootprint(int v0_x, int v0_y, int u0, int v0,
+                            int v1_x, int v1_y, int u1, int v1,
+                            int v2_x, int v2_y, int u2, int v2, precision sub_pixel_precision,
+                            int & du_dx, int & dv_dx, int & du_dy, int & dv_dy);
+    /**
+     * does a color composite to the same pixel over any backdrop, if so, areas of the color
+     * can be filled with that pixel instead of being blended pixel by pixel. never while a
+     * clip mask is pushed, since the mask changes the opacity of every pixel
+     */
+    template<typename BlendMode, typename PorterDuff, microgl::ints::uint8_t a_src>
+    bool compositesToSamePixel(const color_t & color, opacity_t opacity) const;
+
 public:
     /**
      * Draw a triangle with sampler
@@ -979,6 +1393,12 @@ public:
     /**
      * Draw a triangle with 3d shader
      *
+     * NOTE: with floating point shader numbers, varying, that describe their layout (see
+     * shading::varying_layout), are interpolated incrementally. they are exact at the first
+     * pixel of every row and are stepped along the row, so they may drift from the exact
+     * per pixel interpolation by rounding, up to a texel for texture coordinates at the end
+     * of long rows. varying without a layout are interpolated exactly per pixel.
+     *
      * @tparam BlendMode            the blend mode struct
      * @tparam PorterDuff           the alpha compositing struct
      * @tparam antialias            enable/disable anti-aliasing, currently NOT supported
@@ -1015,6 +1435,36 @@ public:
                       const shader_number<Shader>& depth_range_far=shader_number<Shader>(1));
 
 private:
+    /**
+     * passes of the 3d pipeline over the depth buffer:
+     * - shade: shade the fragments, that pass the depth test and write their depth
+     * - depth_only: only write the depths of the fragments, that pass the depth test
+     * - shade_equal: shade the fragments, whose depth equals the depth of the pixel,
+     *   the depth buffer is not written
+     */
+    enum class depth_pass { shade, depth_only, shade_equal };
+
+    /**
+     * Internal draw triangle with shader, clips a triangle, whose vertices were processed by
+     * the vertex shader in homogeneous space and rasterizes the clipped triangles in a depth
+     * pass, see drawTriangle
+     */
+    template <typename BlendMode, typename PorterDuff,
+            bool antialias, bool perspective_correct, bool depth_buffer_flag, depth_pass pass,
+            typename Shader, typename number, typename depth_buffer_type >
+    void drawTriangle_shader_internal(Shader &shader,
+                                      int viewport_width, int viewport_height,
+                                      const vertex4<number> & v0_homo_space,
+                                      const vertex4<number> & v1_homo_space,
+                                      const vertex4<number> & v2_homo_space,
+                                      const varying<Shader> & varying_v0,
+                                      const varying<Shader> & varying_v1,
+                                      const varying<Shader> & varying_v2,
+                                      opacity_t opacity, const microtess::triangles::face_culling & culling,
+                                      depth_buffer_type * depth_buffer,
+                                      const shader_number<Shader>& depth_range_near,
+                                      const shader_number<Shader>& depth_range_far);
+
     /**
      * Internal draw triangle with shader
      * @tparam BlendMode            the blend mode struct
@@ -1022,6 +1472,7 @@ private:
      * @tparam antialias            enable/disable anti-aliasing, currently NOT supported
      * @tparam perspective_correct  enable/disable z-correction
      * @tparam depth_buffer_flag    enable/disable z-buffer
+     * @tparam pass                 the depth pass
      * @tparam Shader               the type of the shader
      * @tparam number               the number type of the varying attributes
      * @tparam depth_buffer_type    The type of the z-buffer
@@ -1044,7 +1495,7 @@ private:
     template <typename BlendMode=blendmode::Normal,
             typename PorterDuff=porterduff::None<>,
             bool antialias=true, bool perspective_correct=false, bool depth_buffer_flag=false,
-            typename Shader, typename number, typename depth_buffer_type >
+            depth_pass pass=depth_pass::shade, typename Shader, typename number, typename depth_buffer_type >
     void drawTriangle_shader_homo_internal(Shader &$shader,
                                            int viewport_width, int viewport_height,
                                            const vertex4<number> &p0,
@@ -1299,6 +1750,7 @@ public:
      * @param v0                uv coord
      * @param u1                uv coord
      * @param v1                uv coord
+     * @param engine            fill engine {tessellation, scanline}, scanline ignores quality and debug
      */
     template<typename BlendMode=blendmode::Normal, typename PorterDuff=porterduff::FastSourceOverOnOpaque,
             bool antialias=false, bool debug=false,
@@ -1312,10 +1764,94 @@ public:
                       const microtess::tess_quality &quality=microtess::tess_quality::better,
                       opacity_t opacity=255,
                       number2 u0=number2(0), number2 v0=number2(1),
-                      number2 u1=number2(1), number2 v1=number2(0));
+                      number2 u1=number2(1), number2 v1=number2(0),
+                      fill_engine engine=fill_engine::tessellation);
+
+private:
+    /**
+     * fill a path without tessellation. every edge of the flattened sub-paths adds the signed
+     * area it covers to the cells of its rows, so the running sum of a row is the winding of
+     * each pixel weighted by its covered area, which is exact anti-aliasing. rows are
+     * accumulated in bands, so the coverage buffer, that is allocated with the allocator
+     * of the path, never has more than path_fill_cells() cells.
+     */
+    template<typename BlendMode, typename PorterDuff, bool antialias,
+            typename number1, typename number2,
+            typename Sampler, template<typename...> class path_container_template,
+            class tessellation_allocator>
+    void drawPathFill_scanline(const Sampler &sampler,
+                               const matrix_3x3<number1> &transform,
+                               microtess::path<number1, path_container_template, tessellation_allocator> &path,
+                               const microtess::fill_rule &rule, opacity_t opacity,
+                               number2 u0, number2 v0, number2 u1, number2 v1);
+
+    /**
+     * fill a path without tessellation, in two passes. triangle fans of the sub-paths add their
+     * orientation to the winding of the pixels they cover in a stencil buffer, then the pixels,
+     * whose winding passes the fill rule are covered with the sampler.
+     */
+    template<typename BlendMode, typename PorterDuff,
+            typename number1, typename number2,
+            typename Sampler, template<typename...> class path_container_template,
+            class tessellation_allocator>
+    void drawPathFill_stencil(const Sampler &sampler,
+                              const matrix_3x3<number1> &transform,
+                              microtess::path<number1, path_container_template, tessellation_allocator> &path,
+                              const microtess::fill_rule &rule, opacity_t opacity,
+                              number2 u0, number2 v0, number2 u1, number2 v1);
+
+    /**
+     * add a value to the stencil of the pixels, whose centers are inside a triangle, with the
+     * same edge functions and top-left rule as drawTriangle_internal, so triangles, that share
+     * an edge never count a pixel twice. the stencil covers the pixels of a rect.
+     */
+    template<class stencil_type>
+    void stencilTriangle_internal(stencil_type & stencil, const rect & stencil_rect,
+                                  int v0_x, int v0_y, int v1_x, int v1_y, int v2_x, int v2_y,
+                                  precision sub_pixel_precision);
+
+    /**
+     * uvs of pixels, that are linear over the bounding box of a path, same as drawTriangles
+     * without uvs. the corners of the box are transformed into canvas space and every pixel
+     * center is mapped back into the box.
+     */
+    struct path_uv_map {
+        static constexpr precision p = 8;
+        rint_big s_x, s_y, e1_x, e1_y, e2_x, e2_y, area, u0, v0, du, dv;
+
+        template<typename number1, typename number2>
+        path_uv_map(const matrix_3x3<number1> & transform, const vertex2<number1> & min,
+                    const vertex2<number1> & max, number2 u_0, number2 v_0, number2 u_1, number2 v_1,
+                    precision uv_precision) {
+#define f microgl::math::to_fixed
+            const auto s0=transform*min, s1=transform*vertex2<number1>{max.x, min.y},
+                    s2=transform*vertex2<number1>{min.x, max.y};
+            s_x=f(s0.x, p); s_y=f(s0.y, p);
+            e1_x=f(s1.x, p)-s_x; e1_y=f(s1.y, p)-s_y; e2_x=f(s2.x, p)-s_x; e2_y=f(s2.y, p)-s_y;
+            area=e1_x*e2_y-e1_y*e2_x;
+            u0=f(u_0, uv_precision); v0=f(v_0, uv_precision);
+            du=f(u_1, uv_precision)-u0; dv=f(v_1, uv_precision)-v0;
+#undef f
+        }
+        // a box, that collapses into a line or a point, has no uvs
+        bool degenerate() const { return area==0; }
+        void operator()(int x, int y, int & u, int & v) const {
+            const rint_big px = (rint_big(x)<<p)+(1<<(p-1))-s_x, py = (rint_big(y)<<p)+(1<<(p-1))-s_y;
+            u = int(u0+((px*e2_y-py*e2_x)*du)/area);
+            v = int(v0+((e1_x*py-e1_y*px)*dv)/area);
+        }
+    };
+
+    // draws the chunks of a text, layout(locations, capacity, previous) lays out a chunk
+    template<bool tint, bool smooth, bool frame, typename bitmap_font_type, typename layout_function>
+    void drawText_internal(microgl::text::bitmap_font<bitmap_font_type> &font, const color_t & color,
+                           const layout_function & layout, int left, int top, int right, int bottom,
+                           opacity_t opacity);
 
+public:
     /**
-     * Draw Bitmap Fonts Text
+     * Draw Bitmap Fonts Text. signed distance field fonts (see bitmap_font::sdf_spread) are
+     * drawn at any size with smooth edges, in the color with 8 bits channels.
      *
      * @tparam tint enable font tinting ?
      * @tparam smooth enable font smooth interpolation if font has scaled ?
@@ -1337,6 +1873,18 @@ public:
                   microgl::text::text_format & format,
                   int left, int top, int right, int bottom, opacity_t opacity=255);
 
+    /**
+     * Draw Bitmap Fonts Text like drawText, with a layout cache, so a text, that is drawn
+     * again with the same font, box and format, is not laid out again, see text::layout_cache.
+     *
+     * @param layouts the layout cache
+     */
+    template<bool tint=true, bool smooth=false, bool frame=false, typename bitmap_font_type,
+             unsigned entries, class Allocator>
+    void drawText(const char *text, microgl::text::bitmap_font<bitmap_font_type> &font, const color_t & color,
+                  microgl::text::text_format & format, microgl::text::layout_cache<entries, Allocator> & layouts,
+                  int left, int top, int right, int bottom, opacity_t opacity=255);
+
 };
 
 #include "canvas.tpp"
@@ -79,6 +79,7 @@ void canvas<bitmap_type, options>::clear(const intensity<number> &color) {
     pixel output;
     microgl::coder::encode<number>(color, output, coder());
     _bitmap_canvas.fill(output);
+    _damage.add(_window.canvas_rect);
 }
 
 template<typename bitmap_type, microgl::ints::uint8_t options>
@@ -86,17 +87,18 @@ void canvas<bitmap_type, options>::clear(const color_t &color) {
     pixel output;
     _bitmap_canvas.coder().encode(color, output);
     _bitmap_canvas.fill(output);
+    _damage.add(_window.canvas_rect);
 }
 
 template<typename bitmap_type, microgl::ints::uint8_t options>
 template<typename BlendMode, typename PorterDuff, microgl::ints::uint8_t a_src>
 void canvas<bitmap_type, options>::blendColor(const color_t &val, int x, int y, opacity_t opacity) {
-    blendColor<BlendMode, PorterDuff, a_src>(val, y*width() + x, opacity, *this);
+    blendColor<BlendMode, PorterDuff, a_src>(val, y*_bitmap_canvas.stride() + x, opacity, *this);
 }
 
 template<typename bitmap_type, microgl::ints::uint8_t options>
 void canvas<bitmap_type, options>::drawPixel(const pixel & val, int x, int y) {
-    _bitmap_canvas.writeAt(y*width()+x, val);
+    _bitmap_canvas.writeAt(x, y, val);
 }
 
 template<typename bitmap_type, microgl::ints::uint8_t options>
@@ -104,6 +106,73 @@ inline void canvas<bitmap_type, options>::drawPixel(const pixel & val, int index
     _bitmap_canvas.writeAt(index - _window.index_correction, val);
 }
 
+// clip masks
+
+template<typename bitmap_type, microgl::ints::uint8_t options>
+template<typename render_function>
+bool canvas<bitmap_type, options>::pushClip(int l, int t, int r, int b, const render_function & render) {
+    if(_clip_count==clip_depth()) return false;
+    rect bounds = rect{l, t, r, b}.intersect(_window.canvas_rect);
+    if(_clip_count) bounds = bounds.intersect(_clips[_clip_count-1].bounds());
+    clip_mask_t & mask = _clips[_clip_count];
+    // rows of the mask have the stride of the bitmap, so a pixel index is a mask offset
+    mask.reset(bounds, _window.canvas_rect.left, _bitmap_canvas.stride());
+    if(!mask.bounds().empty()) {
+        // the mask canvas draws into the coverage, its window is the rows of the mask
+        using mask_bitmap = typename mask_canvas_t::bitmap_t;
+        mask_canvas_t mask_canvas{mask_bitmap(mask.data(), mask.stride(), mask.height())};
+        mask_canvas.updateCanvasWindow(mask.left(), bounds.top);
+        mask_canvas.updateClipRect(bounds.left, bounds.top, bounds.right, bounds.bottom);
+        render(mask_canvas);
+        if(_clip_count) mask.intersect(_clips[_clip_count-1]);
+    }
+    _clip_count++;
+    return true;
+}
+
+template<typename bitmap_type, microgl::ints::uint8_t options>
+template<bool antialias, typename number>
+bool canvas<bitmap_type, options>::pushClipRoundedRect(const number & left, const number & top,
+                                                       const number & right, const number & bottom,
+                                                       const number & radius) {
+    const precision p = renderingOptions()._2d_raster_bits_sub_pixel;
+#define f microgl::math::to_fixed
+    // the anti-aliased edge may cover another pixel
+    return pushClip(f(left, p)>>p, f(top, p)>>p, (f(right, p)>>p)+2, (f(bottom, p)>>p)+2,
+                    [&](mask_canvas_t & mask) {
+        mask.template drawRoundedRect<blendmode::Normal, porterduff::None<>, antialias, number>(
+                sampling::flat_color<rgba_t<0, 0, 0, 8>>{{0, 0, 0, 255}}, sampling::void_sampler{},
+                left, top, right, bottom, radius, number(0));
+    });
+#undef f
+}
+
+template<typename bitmap_type, microgl::ints::uint8_t options>
+template<typename number, template<typename...> class path_container_template, class tessellation_allocator>
+bool canvas<bitmap_type, options>::pushClipPath(const matrix_3x3<number> &transform,
+                                                microtess::path<number, path_container_template, tessellation_allocator> &path,
+                                                const microtess::fill_rule &rule) {
+    const precision p = renderingOptions()._2d_raster_bits_sub_pixel;
+    int min_x=0, min_y=0, max_x=-1, max_y=-1;
+    bool first=true;
+    for (int ix = 0; ix < path.subpathsCount(); ++ix) {
+        const auto sub_path = path.getSubPath(ix);
+        for (int kx = 0; kx < int(sub_path.size()); ++kx) {
+            const auto tp = transform*sub_path[kx];
+            const int x = microgl::math::to_fixed(tp.x, p)>>p, y = microgl::math::to_fixed(tp.y, p)>>p;
+            if(first) { min_x=max_x=x; min_y=max_y=y; first=false; continue; }
+            min_x = functions::min(min_x, x); min_y = functions::min(min_y, y);
+            max_x = functions::max(max_x, x); max_y = functions::max(max_y, y);
+        }
+    }
+    return pushClip(min_x, min_y, max_x+2, max_y+2, [&](mask_canvas_t & mask) {
+        mask.template drawPathFill<blendmode::Normal, porterduff::None<>, true, false, number, number>(
+                sampling::flat_color<rgba_t<0, 0, 0, 8>>{{0, 0, 0, 255}}, transform, path, rule,
+                microtess::tess_quality::better, 255, number(0), number(1), number(1), number(0),
+                mask_canvas_t::fill_engine::scanline);
+    });
+}
+
 // fast common graphics shapes like circles and rounded rectangles
 
 template<typename bitmap_type, microgl::ints::uint8_t options>
@@ -273,6 +342,7 @@ void canvas<bitmap_type, options>::drawArcOrPie_internal(const Sampler &sampler_
     const rect bbox_r = {left_>>p, top_>>p,(right_+aa_range)>>p, (bottom_+aa_range)>>p};
     const rect bbox_r_c = bbox_r.intersect(effectiveRect);
     if(bbox_r_c.empty()) return;
+    _damage.add(bbox_r_c.left, bbox_r_c.top, bbox_r_c.right+1, bbox_r_c.bottom+1);
     // calculate uvs with original unclipped deltas, this way we can always accurately predict blocks
     const auto bits_du=microgl::functions::used_integer_bits(u1-u0);
     const auto bits_dv=microgl::functions::used_integer_bits(v1-v0);
@@ -289,73 +359,118 @@ void canvas<bitmap_type, options>::drawArcOrPie_internal(const Sampler &sampler_
     const int dv = (v1-v0)/(bbox_r.height()); // this occupies (boost_bits=14) bits
     const rint dx=bbox_r_c.left-bbox_r.left, dy=bbox_r_c.top-bbox_r.top;
     color_t color;
-    const int pitch = width();
+    const int pitch = _bitmap_canvas.stride();
     int index = bbox_r_c.top * pitch;
 
     const bool is_convex = functions::orient2d<int, rint_big>(centerX, centerY, cone_ax, cone_ay,
                                                               cone_bx, cone_by, p)>=0;
-//    const bool is_full_cone = cone_ax==cone_bx && cone_ay==cone_by;
-
-    const auto in_cone_lambda = [&is_convex](const int a0x, const int a0y,
-                            const int ax, const int ay,
-                            const int a1x, const int a1y,
-                            const int bx, const int by,
-                            const int precision) -> bool {
-        if(is_convex)
-            return (functions::orient2d<int, rint_big>(ax, ay, bx, by, a1x, a1y, precision)>=0 &&
-                    functions::orient2d<int, rint_big>(bx, by, ax, ay, a0x, a0y, precision)>=0);
-        else
-            return !(functions::orient2d<int, rint_big>(ax, ay, bx, by, a0x, a0y, precision)>0 &&
-                     functions::orient2d<int, rint_big>(bx, by, ax, ay, a1x, a1y, precision)>0);
-    };
+    // the cone in coordinates relative to the center. a point is in a convex cone if it is
+    // left of the ray to (b) and right of the ray to (a) (see functions::orient2d), a point is
+    // in a concave cone if it is not strictly right of the ray to (b) and left of the ray to (a)
+    const rint_big a_x=cone_ax-centerX, a_y=cone_ay-centerY, b_x=cone_bx-centerX, b_y=cone_by-centerY;
+    const rint_big infinity=rint_big(1)<<40;
 
+    const int u_start=u0+dx*du+(du>>1);
     for (rint y_r=bbox_r_c.top, yy=(top_&~mask)+dy*step, v=v0+dy*dv+(dv>>1); y_r<=bbox_r_c.bottom; y_r++, yy+=step, v+=dv, index+=pitch) {
-        for (rint x_r=bbox_r_c.left, xx=(left_&~mask)+dx*step, u=u0+dx*du+(du>>1); x_r<=bbox_r_c.right; x_r++, xx+=step, u+=du) {
-
-            bool in_cone = full_circle || in_cone_lambda(cone_ax, cone_ay, centerX, centerY, cone_bx, cone_by, xx, yy, p);
-            if(!in_cone) continue;
-            int blend_fill=opacity, blend_stroke=opacity;
-            bool inside_radius=false, sample_stroke=false;
+        // the cone is intersected with the row once, the orientation tests are linear in x
+        row_spans cone;
+        if(full_circle) cone.add(bbox_r_c.left, bbox_r_c.right);
+        else {
+            const rint_big row=yy-centerY;
+            rint_big lo=-infinity, hi=infinity;
+            if(is_convex) {
+                narrowRow(b_y, row*b_x, lo, hi);
+                narrowRow(-a_y, -row*a_x, lo, hi);
+                cone.add(centerX+lo, centerX+hi, p, bbox_r_c.left, bbox_r_c.right);
+            } else {
+                narrowRow(a_y, row*a_x+step, lo, hi);
+                narrowRow(-b_y, step-row*b_x, lo, hi);
+                if(lo>hi) cone.add(bbox_r_c.left, bbox_r_c.right);
+                else {
+                    cone.add(centerX-infinity, centerX+lo-1, p, bbox_r_c.left, bbox_r_c.right);
+                    cone.add(centerX+hi+1, centerX+infinity, p, bbox_r_c.left, bbox_r_c.right);
+                }
+            }
+        }
+        if(cone.count==0) continue;
+        // pixels, that are blended at full opacity, are found per row and blended as spans,
+        // these are between the stroke radius (arcs) and the radius
+        row_spans ring;
+        const rint delta_row = yy - centerY, row_squared = (rint(delta_row) * delta_row) >> p;
+        const rint_big outer = diskExtent(radius_squared-row_squared, p);
+        const rint_big inner = draw_pie ? -1 : diskExtent(stroke_radius-1-row_squared, p);
+        if(outer>inner) {
+            ring.add(centerX-outer, centerX-inner-1, p, bbox_r_c.left, bbox_r_c.right);
+            ring.add(centerX+inner+1, centerX+outer, p, bbox_r_c.left, bbox_r_c.right);
+        }
+        // the hole of an arc is skipped, its pixels are not blended
+        row_spans active=cone;
+        if(!draw_pie) {
+            const rint_big hole = diskExtent(functions::min<rint>(radius_squared, stroke_radius-1,
+                    antialias ? inner_aa_radius-1 : radius_squared) - row_squared, p);
+            if(hole>=0) {
+                row_spans outside;
+                outside.add(centerX-infinity, centerX-hole-1, p, bbox_r_c.left, bbox_r_c.right);
+                outside.add(centerX+hole+1, centerX+infinity, p, bbox_r_c.left, bbox_r_c.right);
+                active=cone.intersect(outside);
+            }
+        }
+        const row_spans spans=ring.intersect(active);
+        auto uv = [&](int k, int & u_, int & v_) { u_=(u_start+k*du)>>boost_u; v_=v>>boost_v; };
+        int span=0;
+        for (int c = 0; c < active.count; ++c) {
+            const rint k0=active.from[c]-bbox_r_c.left;
+            for (rint x_r=active.from[c], xx=(left_&~mask)+(dx+k0)*step, u=u_start+k0*du; x_r<=active.to[c]; x_r++, xx+=step, u+=du) {
+                if(span<spans.count && x_r==spans.from[span]) {
+                    const int count=spans.to[span]-x_r+1;
+                    blendSampledSpan<BlendMode, PorterDuff>(sampler_fill, uv, x_r-bbox_r_c.left, count,
+                                                            index+x_r, uv_p, opacity);
+                    x_r+=count-1; xx+=(count-1)*step; u+=(count-1)*du; span++;
+                    continue;
+                }
+                int blend_fill=opacity, blend_stroke=opacity;
+                bool inside_radius=false, sample_stroke=false;
 
-            rint anchor_x=centerX, anchor_y=centerY;
-            rint delta_x = xx - anchor_x, delta_y = yy - anchor_y;
-            const rint distance_squared = ((rint(delta_x) * delta_x) >> p) + ((rint(delta_y) * delta_y) >> p);
-            inside_radius = (distance_squared - radius_squared) <= 0;
+                rint anchor_x=centerX, anchor_y=centerY;
+                rint delta_x = xx - anchor_x, delta_y = yy - anchor_y;
+                const rint distance_squared = ((rint(delta_x) * delta_x) >> p) + ((rint(delta_y) * delta_y) >> p);
+                inside_radius = (distance_squared - radius_squared) <= 0;
 
-            if (inside_radius) { // inside radius
-                if(!draw_pie) {
-                    const bool inside_stroke = (distance_squared - stroke_radius) >= 0;
-                    if (inside_stroke) { // inside stroke disk
-                        blend_stroke = opacity;
-                        sample_stroke=true;
-                    }
-                    else { // below stroke disk, let's sample for AA disk or radius inclusion
-                        const rint delta_inner_aa = -inner_aa_radius + distance_squared;
-                        const bool inside_inner_aa_ring = delta_inner_aa >= 0;
-                        if (antialias && inside_inner_aa_ring) {
-                            // scale inner to 8 bit and then convert to integer
-                            blend_stroke = ((delta_inner_aa) << (8)) / inner_aa_bend;
-                            if (apply_opacity) blend_stroke = (blend_stroke * opacity) >> 8;
+                if (inside_radius) { // inside radius
+                    if(!draw_pie) {
+                        const bool inside_stroke = (distance_squared - stroke_radius) >= 0;
+                        if (inside_stroke) { // inside stroke disk
+                            blend_stroke = opacity;
                             sample_stroke=true;
                         }
+                        else { // below stroke disk, let's sample for AA disk or radius inclusion
+                            const rint delta_inner_aa = -inner_aa_radius + distance_squared;
+                            const bool inside_inner_aa_ring = delta_inner_aa >= 0;
+                            if (antialias && inside_inner_aa_ring) {
+                                // scale inner to 8 bit and then convert to integer
+                                blend_stroke = ((delta_inner_aa) << (8)) / inner_aa_bend;
+                                if (apply_opacity) blend_stroke = (blend_stroke * opacity) >> 8;
+                                sample_stroke=true;
+                            }
+                        }
+                    } else {
+                        sample_stroke=true;
+                    }
+                } else if (antialias) { // we are outside the main radius, AA the outer boundery
+                    const int delta_outer_aa = outer_aa_radius - distance_squared;
+                    const bool inside_outer_aa_ring = delta_outer_aa >= 0;
+                    if (inside_outer_aa_ring) {
+                        // scale inner to 8 bit and then convert to integer
+                        blend_stroke = ((delta_outer_aa) << (8)) / outer_aa_bend;
+                        if (apply_opacity) blend_stroke = (blend_stroke * opacity) >> 8;
+                        sample_stroke=true;
                     }
-                } else {
-                    sample_stroke=true;
-                }
-            } else if (antialias) { // we are outside the main radius, AA the outer boundery
-                const int delta_outer_aa = outer_aa_radius - distance_squared;
-                const bool inside_outer_aa_ring = delta_outer_aa >= 0;
-                if (inside_outer_aa_ring) {
-                    // scale inner to 8 bit and then convert to integer
-                    blend_stroke = ((delta_outer_aa) << (8)) / outer_aa_bend;
-                    if (apply_opacity) blend_stroke = (blend_stroke * opacity) >> 8;
-                    sample_stroke=true;
                 }
-            }
 
-            if (sample_stroke) {
-                sampler_fill.sample(u>>boost_u, v>>boost_v, uv_p, color);
-                blendColor<BlendMode, PorterDuff, Sampler::rgba::a>(color, (index+x_r), blend_stroke, *this);
+                if (sample_stroke) {
+                    sampler_fill.sample(u>>boost_u, v>>boost_v, uv_p, color);
+                    blendColor<BlendMode, PorterDuff, Sampler::rgba::a>(color, (index+x_r), blend_stroke, *this);
+                }
             }
         }
     }
@@ -394,6 +509,7 @@ void canvas<bitmap_type, options>::drawRoundedRect_internal(const Sampler1 & sam
     const rect bbox_r = {left_>>p, top_>>p,(right_+aa_range)>>p, (bottom_+aa_range)>>p};
     const rect bbox_r_c = bbox_r.intersect(effectiveRect);
     if(bbox_r_c.empty()) return;
+    _damage.add(bbox_r_c.left, bbox_r_c.top, bbox_r_c.right+1, bbox_r_c.bottom+1);
     // calculate uvs with original unclipped deltas, this way we can always accurately predict blocks
     const auto bits_du=microgl::functions::used_integer_bits(u1-u0);
     const auto bits_dv=microgl::functions::used_integer_bits(v1-v0);
@@ -410,10 +526,51 @@ void canvas<bitmap_type, options>::drawRoundedRect_internal(const Sampler1 & sam
     const int dv = (v1-v0)/(bbox_r.height()); // this occupies (boost_bits=14) bits
     const rint dx=bbox_r_c.left-bbox_r.left, dy=bbox_r_c.top-bbox_r.top;
     color_t color;
-    const int pitch = width();
+    const int pitch = _bitmap_canvas.stride();
     int index = bbox_r_c.top * pitch;
+    // pixels, that are only filled at full opacity, are found per row and blended as spans.
+    // in the disks, these are closer to the anchor than the solid radius.
+    const rint anchor_left=left_+radius, anchor_right=right_-radius;
+    const rint anchor_top=top_+radius, anchor_bottom=bottom_-radius;
+    rint solid_radius = radius_squared;
+    if(!void_sampler_2) {
+        solid_radius = functions::min<rint>(solid_radius, stroke_radius-1);
+        if(antialias) solid_radius = functions::min<rint>(solid_radius, inner_aa_radius-1);
+    }
+    const int u_start=u0+dx*du+(du>>1);
     for (rint y_r=bbox_r_c.top, yy=(top_&~mask)+dy*step, v=v0+dy*dv+(dv>>1); y_r<=bbox_r_c.bottom; y_r++, yy+=step, v+=dv, index+=pitch) {
+        row_spans spans;
+        const bool in_band = yy<=anchor_top || yy>=anchor_bottom;
+        rint middle_left=(left_&~mask), middle_right=right_;
+        if(!void_sampler_2) {
+            middle_left=functions::max<rint>(middle_left, (left_&~mask)+stroke+1);
+            middle_right=functions::min<rint>(middle_right, (right_&~mask)-stroke-1);
+        }
+        const bool solid_middle = yy<=bottom_ && (void_sampler_2 ||
+                (yy-(top_&~mask)>stroke && yy<(bottom_&~mask)-stroke));
+        if(in_band) {
+            const rint anchor_y= yy>=anchor_bottom ? anchor_bottom : anchor_top;
+            const rint delta_y= yy-anchor_y;
+            const rint_big extent=diskExtent(solid_radius-((rint(delta_y)*delta_y)>>p), p);
+            if(extent>=0) spans.add(anchor_left-extent, functions::min<rint>(anchor_left, anchor_right-1),
+                                    p, bbox_r_c.left, bbox_r_c.right);
+            if(solid_middle) spans.add(functions::max<rint>(middle_left, anchor_left+1),
+                                       functions::min<rint>(middle_right, anchor_right-1),
+                                       p, bbox_r_c.left, bbox_r_c.right);
+            if(extent>=0) spans.add(anchor_right, anchor_right+extent, p, bbox_r_c.left, bbox_r_c.right);
+        } else if(solid_middle)
+            spans.add(middle_left, middle_right, p, bbox_r_c.left, bbox_r_c.right);
+        auto uv = [&](int k, int & u_, int & v_) { u_=(u_start+k*du)>>boost_u; v_=v>>boost_v; };
+        int span=0;
         for (rint x_r=bbox_r_c.left, xx=(left_&~mask)+dx*step, u=u0+dx*du+(du>>1); x_r<=bbox_r_c.right; x_r++, xx+=step, u+=du) {
+            if(span<spans.count && x_r==spans.from[span]) {
+                const int count=spans.to[span]-x_r+1;
+                if(!void_sampler_1)
+                    blendSampledSpan<BlendMode, PorterDuff>(sampler_fill, uv, x_r-bbox_r_c.left, count,
+                                                            index+x_r, uv_p, opacity);
+                x_r+=count-1; xx+=(count-1)*step; u+=(count-1)*du; span++;
+                continue;
+            }
             int blend_fill=opacity, blend_stroke=opacity;
             bool inside_radius;
             bool sample_fill=true, sample_stroke=false;
@@ -551,17 +708,27 @@ void canvas<bitmap_type, options>::drawRect_internal(const Sampler & sampler,
                                                      precision sub_pixel_precision,
                                                      precision uv_precision,
                                                      opacity_t opacity) {
+    if(sampling::has_levels<Sampler>::value) { // compile-time branching
+        if(left==right || top==bottom) return;
+        const precision p = sub_pixel_precision;
+        using levels = sampling::levels<Sampler>;
+        drawRect_internal<BlendMode, PorterDuff, antialias, typename levels::type>(
+                levels::of(sampler, int((microgl::ints::int64_t(u1-u0)<<p)/(right-left)), 0,
+                           0, int((microgl::ints::int64_t(v1-v0)<<p)/(bottom-top)), uv_precision),
+                left, top, right, bottom, u0, v0, u1, v1, sub_pixel_precision, uv_precision, opacity);
+        return;
+    }
     auto effectiveRect = calculateEffectiveDrawRect();
     if(effectiveRect.empty()) return;
 #define ceil_fixed(val, bits) ((val)&((1<<bits)-1) ? ((val>>bits)+1) : (val>>bits))
 #define floor_fixed(val, bits) (val>>bits)
-    color_t col_bmp{};
     const precision p= sub_pixel_precision;
     if(left==right || top==bottom) return;
     const rect bbox_r = {floor_fixed(left, p), floor_fixed(top, p),
                          ceil_fixed(right, p)-0, ceil_fixed(bottom, p)-0};
     const rect bbox_r_c = bbox_r.intersect(effectiveRect);
     if(bbox_r_c.empty()) return;
+    _damage.add(bbox_r_c.left, bbox_r_c.top, bbox_r_c.right+1, bbox_r_c.bottom+1);
     // calculate uvs with original unclipped deltas, this way we can always accurately predict blocks
     const auto bits_du=microgl::functions::used_integer_bits(u1-u0);
     const auto bits_dv=microgl::functions::used_integer_bits(v1-v0);
@@ -577,7 +744,7 @@ void canvas<bitmap_type, options>::drawRect_internal(const Sampler & sampler,
     const int du = (u1-u0)/(bbox_r.right-bbox_r.left); // this occupies (boost_bits=14) bits
     const int dv = (v1-v0)/(bbox_r.bottom-bbox_r.top); // this occupies (boost_bits=14) bits
     const int dx= bbox_r_c.left-bbox_r.left, dy= bbox_r_c.top-bbox_r.top;
-    const int pitch= width();
+    const int pitch= _bitmap_canvas.stride();
     if(antialias) {
         const bool clipped_left=bbox_r.left!=bbox_r_c.left, clipped_top=bbox_r.top!=bbox_r_c.top;
         const bool clipped_right=bbox_r.right!=bbox_r_c.right, clipped_bottom=bbox_r.bottom!=bbox_r_c.bottom;
@@ -594,8 +761,15 @@ void canvas<bitmap_type, options>::drawRect_internal(const Sampler & sampler,
         const int blend_bottom= (int(opacity)*coverage_bottom)>>p;
         int index= (bbox_r_c.top) * pitch;
         opacity_t blend=0;
+        const int u_start=u0+(du>>1)+dx*du;
+        color_t colors[span_chunk()];
         for (int y=bbox_r_c.top, v=v0+(dv>>1)+dy*dv; y<=bbox_r_c.bottom; y++, v+=dv, index+=pitch) {
-            for (int x=bbox_r_c.left, u=u0+(du>>1)+dx*du; x<=bbox_r_c.right; x++, u+=du) {
+            auto uv = [&](int k, int & u_, int & v_) { u_=(u_start+k*du)>>boost_u; v_=v>>boost_v; };
+            for (int x=bbox_r_c.left; x<=bbox_r_c.right; x++) {
+                const int k = x-bbox_r_c.left, chunk_ix = k%span_chunk();
+                if(chunk_ix==0)
+                    sampleSpan(sampler, uv, k, functions::min<int>(span_chunk(), bbox_r_c.right-x+1),
+                               uv_precision, colors);
                 blend=opacity;
                 if(x==bbox_r_c.left && !clipped_left) {
                     if(y==bbox_r_c.top && !clipped_top) blend= blend_left_top;
@@ -609,17 +783,36 @@ void canvas<bitmap_type, options>::drawRect_internal(const Sampler & sampler,
                 }
                 else if(y==bbox_r_c.top && !clipped_top) blend= blend_top;
                 else if(y==bbox_r_c.bottom && !clipped_bottom) blend= blend_bottom;
-                sampler.sample(u>>boost_u, v>>boost_v, uv_precision, col_bmp);
-                blendColor<BlendMode, PorterDuff, Sampler::rgba::a>(col_bmp, index + x, blend, *this);
+                blendColor<BlendMode, PorterDuff, Sampler::rgba::a>(colors[chunk_ix], index + x, blend, *this);
             }
         }
     }
     else {
+        // bbox_r is right/bottom exclusive, while the effective rect is inclusive
+        const int right_c = functions::min(bbox_r.right, effectiveRect.right+1);
+        const int bottom_c = functions::min(bbox_r.bottom, effectiveRect.bottom+1);
+        if(sampling::is_flat_color<Sampler>::value) {
+            color_t color;
+            sampler.sample(0, 0, uv_precision, color);
+            if(compositesToSamePixel<BlendMode, PorterDuff, Sampler::rgba::a>(color, opacity)) {
+                // composite the first pixel and fill the rest with it
+                const int first = bbox_r_c.top * pitch + bbox_r_c.left;
+                blendColor<BlendMode, PorterDuff, Sampler::rgba::a>(color, first, opacity, *this);
+                const pixel value = _bitmap_canvas.pixelAt(first - _window.index_correction);
+                const int l = _window.canvas_rect.left, t = _window.canvas_rect.top;
+                _bitmap_canvas.fill_rect({bbox_r_c.left - l, bbox_r_c.top - t, right_c - l, bottom_c - t}, value);
+                return;
+            }
+        }
         int index= bbox_r_c.top * pitch;
-        for (int y=bbox_r_c.top, v=v0+(dv>>1)+dy*dv; y<bbox_r_c.bottom; y++, v+=dv, index+=pitch) {
-            for (int x=bbox_r_c.left, u=u0+(du>>1)+dx*du; x<bbox_r_c.right; x++, u+=du) {
-                sampler.sample(u>>boost_u, v>>boost_v, uv_precision, col_bmp);
-                blendColor<BlendMode, PorterDuff, Sampler::rgba::a>(col_bmp, index + x, opacity, *this);
+        const int u_start=u0+(du>>1)+dx*du;
+        color_t colors[span_chunk()];
+        for (int y=bbox_r_c.top, v=v0+(dv>>1)+dy*dv; y<bottom_c; y++, v+=dv, index+=pitch) {
+            auto uv = [&](int k, int & u_, int & v_) { u_=(u_start+k*du)>>boost_u; v_=v>>boost_v; };
+            for (int x=bbox_r_c.left; x<right_c; x+=span_chunk()) {
+                const int count = functions::min<int>(span_chunk(), right_c-x);
+                sampleSpan(sampler, uv, x-bbox_r_c.left, count, uv_precision, colors);
+                blendSpan<BlendMode, PorterDuff, Sampler::rgba::a>(colors, nullptr, opacity, index + x, count, *this);
             }
         }
     }
@@ -638,6 +831,23 @@ void canvas<bitmap_type, options>::drawQuadrilateral(const Shader & sampler,
                                                 const microgl::ints::uint8_t opacity) {
     const precision uv_p = renderingOptions()._2d_raster_bits_uv, pixel_p = renderingOptions()._2d_raster_bits_sub_pixel;
 #define f microgl::math::to_fixed
+    if(sampling::has_levels<Shader>::value) { // compile-time branching
+        // both halves sample the levels of the bigger footprint, so they meet without a seam
+        int a[4], b[4];
+        uvFootprint(f(v0_x, pixel_p), f(v0_y, pixel_p), f(u0, uv_p), f(v0, uv_p),
+                    f(v1_x, pixel_p), f(v1_y, pixel_p), f(u1, uv_p), f(v1, uv_p),
+                    f(v2_x, pixel_p), f(v2_y, pixel_p), f(u2, uv_p), f(v2, uv_p), pixel_p, a[0], a[1], a[2], a[3]);
+        uvFootprint(f(v2_x, pixel_p), f(v2_y, pixel_p), f(u2, uv_p), f(v2, uv_p),
+                    f(v3_x, pixel_p), f(v3_y, pixel_p), f(u3, uv_p), f(v3, uv_p),
+                    f(v0_x, pixel_p), f(v0_y, pixel_p), f(u0, uv_p), f(v0, uv_p), pixel_p, b[0], b[1], b[2], b[3]);
+        for (int ix = 0; ix < 4; ++ix)
+            a[ix] = functions::max<int>(a[ix]<0 ? -a[ix] : a[ix], b[ix]<0 ? -b[ix] : b[ix]);
+        using levels = sampling::levels<Shader>;
+        drawQuadrilateral<BlendMode, PorterDuff, antialias, number1, number2, typename levels::type>(
+                levels::of(sampler, a[0], a[1], a[2], a[3], uv_p),
+                v0_x, v0_y, u0, v0, v1_x, v1_y, u1, v1, v2_x, v2_y, u2, v2, v3_x, v3_y, u3, v3, opacity);
+        return;
+    }
     number2 q0 = 1, q1 = 1, q2 = 1, q3 = 1;
     number1 p0x = v0_x; number1 p0y = v0_y;
     number1 p1x = v1_x; number1 p1y = v1_y;
@@ -690,7 +900,8 @@ void canvas<bitmap_type, options>::drawQuadrilateral(const Shader & sampler,
 // Triangles
 
 template<typename bitmap_type, microgl::ints::uint8_t options>
-template<typename BlendMode, typename PorterDuff, bool antialias, typename number1, typename number2, typename Sampler>
+template<typename BlendMode, typename PorterDuff, bool antialias, typename number1, typename number2, typename Sampler,
+        class Allocator>
 void canvas<bitmap_type, options>::drawTriangles(const Sampler &sampler,
                                             const matrix_3x3<number1> &transform,
                                             const vertex2<number1> *vertices,
@@ -701,23 +912,50 @@ void canvas<bitmap_type, options>::drawTriangles(const Sampler &sampler,
                                             const enum indices type,
                                             const opacity_t opacity,
                                             const number2 &u0, const number2 &v0,
-                                            const number2 &u1, const number2 &v1) {
+                                            const number2 &u1, const number2 &v1,
+                                            const Allocator & allocator) {
     constexpr bool void_sampler = microgl::traits::is_same<Sampler, microgl::sampling::void_sampler>::value;
     static_assert_rgb<typename pixel_coder::rgba, typename Sampler::rgba, void_sampler>();
-    if(void_sampler) return;
+    if(void_sampler || size<3) return;
 #define f microgl::math::to_fixed
     const precision p = renderingOptions()._2d_raster_bits_sub_pixel;
     const precision uv_p = renderingOptions()._2d_raster_bits_uv;
-    vertex2<number1> min, max;
-    if(!uvs && size) { // if we don't have per-vertex uv, then let's compute
-        min.x=max.x=indices ? vertices[indices[0]].x : vertices[0].x;
-        min.y=max.y=indices ? vertices[indices[0]].y : vertices[0].y;
-        for (unsigned ix = 0; ix < size; ++ix) { // compute bounding box
-            const auto & pt = indices ? vertices[indices[ix]] : vertices[ix];
-            if(pt.x<min.x) min.x=pt.x; if(pt.y < min.y) min.y=pt.y;
-            if(pt.x>max.x) max.x=pt.x; if(pt.y > max.y) max.y=pt.y;
-        }
+    // count the vertices and if we don't have per-vertex uv, compute the bounding box of the used vertices
+    vertex2<number1> min = indices ? vertices[indices[0]] : vertices[0], max = min;
+    index count = indices ? 0 : size;
+    for (index ix = 0; ix < size; ++ix) {
+        const index id = indices ? indices[ix] : ix;
+        if(id>=count) count=id+1;
+        if(uvs) continue;
+        const auto & pt = vertices[id];
+        if(pt.x<min.x) min.x=pt.x;
+        if(pt.y<min.y) min.y=pt.y;
+        if(pt.x>max.x) max.x=pt.x;
+        if(pt.y>max.y) max.y=pt.y;
     }
+    // vertex stage, a vertex is transformed and converted to fixed point once, when a triangle
+    // first uses it, into a scratch buffer of {x[count], y[count], u[count], v[count], ready[count]},
+    // so shared vertices are not transformed again and vertices, that no index uses, not at all.
+    // small meshes keep the buffer on the stack, bigger meshes allocate it
+    using int_allocator = typename Allocator::template rebind<int>::other;
+    int_allocator int_alloc(allocator);
+    int stack_buffer[vertex_stage_stack_size()*5];
+    const bool on_heap = count > index(vertex_stage_stack_size());
+    int * const buffer = on_heap ? int_alloc.allocate(count*5) : stack_buffer;
+    int * const xs = buffer, * const ys = xs + count, * const us = ys + count, * const vs = us + count;
+    int * const ready = vs + count;
+    for (index ix = 0; ix < count; ++ix) ready[ix]=0;
+    const vertex2<number2> uv_s{u0, v0}, uv_d{u1 - u0, v1 - v0};
+    auto vertex_stage = [&](const index id) {
+        if(ready[id]) return;
+        const auto & pt = vertices[id];
+        auto uv = uvs ? uvs[id] : vertex2<number2>(pt - min) / vertex2<number2>(max - min);
+        uv = uv_s + uv*uv_d;
+        const auto tp = transform*pt;
+        xs[id]=f(tp.x, p); ys[id]=f(tp.y, p);
+        us[id]=f(uv.x, uv_p); vs[id]=f(uv.y, uv_p);
+        ready[id]=1;
+    };
     microtess::triangles::iterate_triangles(indices, size, type, // we use lambda because of it's capturing capabilities
           [&](const index &idx, const index &first_index, const index &second_index, const index &third_index,
               const index &edge_0_id, const index &edge_1_id, const index &edge_2_id) {
@@ -737,30 +975,20 @@ void canvas<bitmap_type, options>::drawTriangles(const Sampler &sampler,
                       aa_third_edge = idx==(size-3);
                   }
               }
-
-              auto p1= vertices[first_index], p2=vertices[second_index], p3=vertices[third_index];
-              vertex2<number2> uv_s{u0, v0}, uv_e{u1, v1}, uv_d{u1 - u0, v1 - v0};
-              auto uv1= uvs? uvs[first_index] : vertex2<number2>(p1 - min) / vertex2<number2>(max - min);
-              auto uv2= uvs? uvs[second_index] : vertex2<number2>(p2 - min) / vertex2<number2>(max - min);
-              auto uv3= uvs? uvs[third_index] : vertex2<number2>(p3 - min) / vertex2<number2>(max - min);
-              uv1= uv_s+uv1*uv_d, uv2= uv_s+uv2*uv_d, uv3= uv_s+uv3*uv_d;
-              p1=transform*p1;p2=transform*p2;p3=transform*p3;
+              vertex_stage(first_index); vertex_stage(second_index); vertex_stage(third_index);
               drawTriangle_internal<BlendMode, PorterDuff, antialias, false, Sampler>(sampler,
-                                                                      f(p1.x, p), f(p1.y, p),
-                                                                      f(uv1.x, uv_p), f(uv1.y, uv_p), 0,
-                                                                      f(p2.x, p), f(p2.y, p),
-                                                                      f(uv2.x, uv_p), f(uv2.y, uv_p), 0,
-                                                                      f(p3.x, p), f(p3.y, p),
-                                                                      f(uv3.x, uv_p), f(uv3.y, uv_p), 0,
-                                                                      opacity, p, uv_p, aa_first_edge,
-                                                                      aa_second_edge, aa_third_edge);
+                                      xs[first_index], ys[first_index], us[first_index], vs[first_index], 0,
+                                      xs[second_index], ys[second_index], us[second_index], vs[second_index], 0,
+                                      xs[third_index], ys[third_index], us[third_index], vs[third_index], 0,
+                                      opacity, p, uv_p, aa_first_edge, aa_second_edge, aa_third_edge);
           });
+    if(on_heap) int_alloc.deallocate(buffer, count*5);
 #undef f
 }
 
 template<typename bitmap_type, microgl::ints::uint8_t options>
 template<typename BlendMode, typename PorterDuff, bool antialias, bool perspective_correct, bool depth_buffer_flag,
-        typename Shader, typename depth_buffer_type>
+        bool depth_pre_pass, typename Shader, typename depth_buffer_type>
 void canvas<bitmap_type, options>::drawTriangles(Shader &shader,
                                             int viewport_width, int viewport_height,
                                             const  vertex_attributes<Shader> *vertex_buffer,
@@ -770,14 +998,44 @@ void canvas<bitmap_type, options>::drawTriangles(Shader &shader,
                                             const microtess::triangles::face_culling & culling,
                                             depth_buffer_type *depth_buffer, const opacity_t opacity,
                                             const shader_number<Shader>& depth_range_near, const shader_number<Shader>& depth_range_far) {
+    static_assert_rgb<typename pixel_coder::rgba, shader_rgba<Shader>>();
+    using varying = shading::varying<Shader>;
+    using number = shading::shader_number<Shader>;
+    // post-transform cache, every vertex is shaded once into a direct mapped cache, that is indexed
+    // by its index, so triangles, that share it find it there. vertices of meshes with up to
+    // vertex_cache_size() vertices are shaded exactly once
+    struct shaded_vertex { index id; vertex4<number> position; varying output; };
+    shaded_vertex cache[vertex_cache_size()];
+    for (auto & vertex : cache) vertex.id = ~index(0);
+    auto shade = [&](const index id) -> const shaded_vertex & {
+        auto & vertex = cache[id & (vertex_cache_size()-1)];
+        if(vertex.id!=id) {
+            vertex.id = id;
+            vertex.position = shader.vertex(vertex_buffer[id], vertex.output);
+        }
+        return vertex;
+    };
+    constexpr bool pre_pass = depth_buffer_flag && depth_pre_pass;
+    if(pre_pass) { // write the depths of all of the triangles first
+        microtess::triangles::iterate_triangles(indices, size, type,
+              [&](const index &, const index &first_index, const index &second_index, const index &third_index,
+                  const index &, const index &, const index &) {
+                  // copies, vertices of a triangle may evict each other
+                  const shaded_vertex v0 = shade(first_index), v1 = shade(second_index), v2 = shade(third_index);
+                  drawTriangle_shader_internal<BlendMode, PorterDuff, antialias, perspective_correct, depth_buffer_flag,
+                          depth_pass::depth_only>(shader, viewport_width, viewport_height,
+                          v0.position, v1.position, v2.position, v0.output, v1.output, v2.output,
+                          opacity, culling, depth_buffer, depth_range_near, depth_range_far);
+              });
+    }
     microtess::triangles::iterate_triangles(indices, size, type, // we use lambda because of it's capturing capabilities
           [&](const index &idx, const index &first_index, const index &second_index, const index &third_index,
               const index &edge_0_id, const index &edge_1_id, const index &edge_2_id) {
-              drawTriangle<BlendMode, PorterDuff, antialias, perspective_correct, depth_buffer_flag>(
+              const shaded_vertex v0 = shade(first_index), v1 = shade(second_index), v2 = shade(third_index);
+              drawTriangle_shader_internal<BlendMode, PorterDuff, antialias, perspective_correct, depth_buffer_flag,
+                      pre_pass ? depth_pass::shade_equal : depth_pass::shade>(
                       shader, viewport_width, viewport_height,
-                      vertex_buffer[first_index],
-                      vertex_buffer[second_index],
-                      vertex_buffer[third_index],
+                      v0.position, v1.position, v2.position, v0.output, v1.output, v2.output,
                       opacity, culling, depth_buffer, depth_range_near, depth_range_far);
           });
 }
@@ -812,6 +1070,130 @@ void canvas<bitmap_type, options>::drawTriangleWireframe(const color_t &color,
 }
 
 
+template<typename bitmap_type, microgl::ints::uint8_t options>
+void canvas<bitmap_type, options>::clipSpanToEdge(rint_big w, rint_big A, rint_big threshold, int & from, int & to) {
+    if(A==0) { // constant along the row
+        if(w<threshold) to=from-1;
+        return;
+    }
+    if(A>0) { // k >= ceil((threshold-w)/A)
+        const rint_big n = threshold - w;
+        const rint_big k = n<=0 ? -((-n)/A) : (n+A-1)/A;
+        if(k>from) from = k>to ? to+1 : int(k);
+    } else { // k <= floor((w-threshold)/(-A))
+        const rint_big n = w - threshold, d = -A;
+        const rint_big k = n>=0 ? n/d : -((-n+d-1)/d);
+        if(k<to) to = k<from ? from-1 : int(k);
+    }
+}
+
+template<typename bitmap_type, microgl::ints::uint8_t options>
+void canvas<bitmap_type, options>::edgeBlockBounds(rint_big w, rint_big A, rint_big B, int width, int height,
+                                                   rint_big & min, rint_big & max) {
+    const rint_big dx = A*(width-1), dy = B*(height-1);
+    min = w + (dx<0 ? dx : 0) + (dy<0 ? dy : 0);
+    max = w + (dx>0 ? dx : 0) + (dy>0 ? dy : 0);
+}
+
+template<typename bitmap_type, microgl::ints::uint8_t options>
+auto canvas<bitmap_type, options>::diskExtent(rint_big range, precision p) -> rint_big {
+    if(range<0) return -1;
+    rint_big d = microgl::math::sqrt_64((microgl::ints::uint64_t(range+1)<<p)-1);
+    // the root is exact, the corrections guard against the rounding of other roots
+    while (((d+1)*(d+1)>>p)<=range) ++d;
+    while (d>0 && ((d*d)>>p)>range) --d;
+    return d;
+}
+
+template<typename bitmap_type, microgl::ints::uint8_t options>
+void canvas<bitmap_type, options>::narrowRow(rint_big k, rint_big c, rint_big & lo, rint_big & hi) {
+    // floor division by a positive divisor
+    const auto floor_div = [](rint_big n, rint_big d) -> rint_big { return n>=0 ? n/d : -((d-1-n)/d); };
+    if(k>0) lo = functions::max<rint_big>(lo, -floor_div(-c, k));
+    else if(k<0) hi = functions::min<rint_big>(hi, floor_div(-c, -k));
+    else if(c>0) { lo=1; hi=0; }
+}
+
+template<typename bitmap_type, microgl::ints::uint8_t options>
+template<typename BlendMode, typename PorterDuff, typename Sampler, typename uv_function>
+void canvas<bitmap_type, options>::blendSampledSpan(const Sampler & sampler, const uv_function & uv,
+                                                    int from, int count, int index,
+                                                    precision uv_precision, opacity_t opacity) {
+    if(sampling::is_flat_color<Sampler>::value) { // compile-time branching
+        color_t color;
+        sampler.sample(0, 0, uv_precision, color);
+        if(compositesToSamePixel<BlendMode, PorterDuff, Sampler::rgba::a>(color, opacity)) {
+            // composite the first pixel and fill the rest with it
+            blendColor<BlendMode, PorterDuff, Sampler::rgba::a>(color, index, opacity, *this);
+            const pixel value = _bitmap_canvas.pixelAt(index - _window.index_correction);
+            if(count>1) _bitmap_canvas.fill_span(index + 1 - _window.index_correction, count-1, value);
+            return;
+        }
+    }
+    color_t colors[span_chunk()];
+    for (int k = 0; k < count; k+=span_chunk()) {
+        const int n = functions::min<int>(span_chunk(), count-k);
+        sampleSpan(sampler, uv, from+k, n, uv_precision, colors);
+        blendSpan<BlendMode, PorterDuff, Sampler::rgba::a>(colors, nullptr, opacity, index+k, n, *this);
+    }
+}
+
+template<typename bitmap_type, microgl::ints::uint8_t options>
+template<typename BlendMode, typename PorterDuff, microgl::ints::uint8_t a_src>
+bool canvas<bitmap_type, options>::compositesToSamePixel(const color_t & color, opacity_t opacity) const {
+    using traits = porterduff::porter_duff_traits<PorterDuff>;
+    if(_clip_count) return false;
+    // other blend modes mix with the backdrop color
+    if(!microgl::traits::is_same<BlendMode, blendmode::Normal>::value) return false;
+    if(traits::ignores_backdrop) return true;
+    constexpr unsigned alpha_max_value = (1u << (a_src ? a_src : 8)) - 1;
+    return traits::opaque_source_ignores_backdrop && opacity==255 && color.a==alpha_max_value;
+}
+
+template<typename bitmap_type, microgl::ints::uint8_t options>
+template<typename Sampler, typename uv_function>
+void canvas<bitmap_type, options>::sampleSpan(const Sampler & sampler, const uv_function & uv, int from, int count,
+                                              precision uv_precision, color_t * output) {
+    int u, v;
+    if(sampling::has_sample_span<Sampler>::value) { // compile-time branching
+        constexpr precision F = sampling::span_fraction_bits;
+        int u_last, v_last, du=0, dv=0;
+        uv(from, u, v);
+        if(count>1) {
+            uv(from+count-1, u_last, v_last);
+            // deltas with fraction bits, so the error is at most one unit at every pixel
+            du=((u_last-u)*(1<<F))/(count-1); dv=((v_last-v)*(1<<F))/(count-1);
+        }
+        sampling::sample_span(sampler, u*(1<<F), v*(1<<F), du, dv, uv_precision, count, output);
+    } else {
+        for (int ix = 0; ix < count; ++ix) {
+            uv(from+ix, u, v);
+            sampler.sample(u, v, uv_precision, output[ix]);
+        }
+    }
+}
+
+template<typename bitmap_type, microgl::ints::uint8_t options>
+void canvas<bitmap_type, options>::uvFootprint(int v0_x, int v0_y, int u0, int v0,
+                                               int v1_x, int v1_y, int u1, int v1,
+                                               int v2_x, int v2_y, int u2, int v2, precision sub_pixel_precision,
+                                               int & du_dx, int & dv_dx, int & du_dy, int & dv_dy) {
+    using int64 = microgl::ints::int64_t;
+    du_dx=dv_dx=du_dy=dv_dy=0;
+    const int64 x1=v1_x-v0_x, y1=v1_y-v0_y, x2=v2_x-v0_x, y2=v2_y-v0_y;
+    const int64 area = x1*y2 - x2*y1;
+    if(area==0) return;
+    // gradients of the linear uvs, the positions have sub pixel precision
+    const int64 du1=u1-u0, dv1=v1-v0, du2=u2-u0, dv2=v2-v0;
+    const int64 limit = int64(1)<<30;
+    auto gradient = [&](const int64 numerator) {
+        const int64 g = (numerator<<sub_pixel_precision)/area;
+        return int(functions::clamp<int64>(g, -limit, limit));
+    };
+    du_dx = gradient(du1*y2 - du2*y1); dv_dx = gradient(dv1*y2 - dv2*y1);
+    du_dy = gradient(du2*x1 - du1*x2); dv_dy = gradient(dv2*x1 - dv1*x2);
+}
+
 template<typename bitmap_type, microgl::ints::uint8_t options>
 template<typename BlendMode, typename PorterDuff, bool antialias, bool perspective_correct, typename Sampler>
 void canvas<bitmap_type, options>::drawTriangle_internal(const Sampler &sampler,
@@ -820,6 +1202,18 @@ void canvas<bitmap_type, options>::drawTriangle_internal(const Sampler &sampler,
                                                          int v2_x, int v2_y, int u2, int v2, int q2,
                                                          opacity_t opacity, precision sub_pixel_precision,
                                                          precision uv_precision, bool aa_first_edge, bool aa_second_edge, bool aa_third_edge) {
+    // perspective correct triangles are halves of quadrilaterals, which pick the levels of both halves
+    if(sampling::has_levels<Sampler>::value && !perspective_correct) { // compile-time branching
+        int du_dx, dv_dx, du_dy, dv_dy;
+        uvFootprint(v0_x, v0_y, u0, v0, v1_x, v1_y, u1, v1, v2_x, v2_y, u2, v2, sub_pixel_precision,
+                    du_dx, dv_dx, du_dy, dv_dy);
+        using levels = sampling::levels<Sampler>;
+        drawTriangle_internal<BlendMode, PorterDuff, antialias, perspective_correct, typename levels::type>(
+                levels::of(sampler, du_dx, dv_dx, du_dy, dv_dy, uv_precision),
+                v0_x, v0_y, u0, v0, q0, v1_x, v1_y, u1, v1, q1, v2_x, v2_y, u2, v2, q2,
+                opacity, sub_pixel_precision, uv_precision, aa_first_edge, aa_second_edge, aa_third_edge);
+        return;
+    }
     constexpr precision precision_one_over_area=15;
     constexpr precision P_AA = 16;
     constexpr bool divide=options_use_division(); // compile time flag
@@ -863,7 +1257,9 @@ void canvas<bitmap_type, options>::drawTriangle_internal(const Sampler &sampler,
     bbox.top = floor_fixed(functions::min<rint>(v0_y, v1_y, v2_y)&mask, sub_pixel_precision);
     bbox.right = ceil_fixed(functions::max<rint>(v0_x, v1_x, v2_x), sub_pixel_precision);
     bbox.bottom = ceil_fixed(functions::max<rint>(v0_y, v1_y, v2_y), sub_pixel_precision);
+    const rect bbox_unclipped = bbox;
     bbox = bbox.intersect(effectiveRect); // raster clipping
+    _damage.add(bbox.left, bbox.top, bbox.right+1, bbox.bottom+1);
 #undef ceil_fixed
 #undef floor_fixed
 
@@ -903,72 +1299,183 @@ void canvas<bitmap_type, options>::drawTriangle_internal(const Sampler &sampler,
         A01_h = (((rint_big)(v0_y - v1_y))<<P_AA)/length_w0, B01_h = (((rint_big)(v1_x - v0_x))<<P_AA)/length_w0;
         A12_h = (((rint_big)(v1_y - v2_y))<<P_AA)/length_w1, B12_h = (((rint_big)(v2_x - v1_x))<<P_AA)/length_w1;
         A20_h = (((rint_big)(v2_y - v0_y))<<P_AA)/length_w2, B20_h = (((rint_big)(v0_x - v2_x))<<P_AA)/length_w2;
-        w0_row_h = (((rint_big)(w0_row))<<P_AA)/length_w0;
-        w1_row_h = (((rint_big)(w1_row))<<P_AA)/length_w1;
-        w2_row_h = (((rint_big)(w2_row))<<P_AA)/length_w2;
+        // distances are computed at the un-clipped corner and then advanced, so rounding does not
+        // depend on the clipping and blocks render exactly as the whole canvas does
+        const rint_big dx = bbox.left - bbox_unclipped.left, dy = bbox.top - bbox_unclipped.top;
+        w0_row_h = ((((rint_big)(w0_row) - dx*A01 - dy*B01)<<P_AA)/length_w0) + dx*A01_h + dy*B01_h;
+        w1_row_h = ((((rint_big)(w1_row) - dx*A12 - dy*B12)<<P_AA)/length_w1) + dx*A12_h + dy*B12_h;
+        w2_row_h = ((((rint_big)(w2_row) - dx*A20 - dy*B20)<<P_AA)/length_w2) + dx*A20_h + dy*B20_h;
     }
-    const int pitch= width();
-    int index = p.y * pitch;
-    for (p.y = bbox.top; p.y <= bbox.bottom; p.y++, index+=pitch) {
-        rint w0=w0_row, w1=w1_row, w2=w2_row, w0_h=0, w1_h=0, w2_h=0;
-        if(antialias) { w0_h=w0_row_h; w1_h=w1_row_h; w2_h=w2_row_h; }
-        for (p.x = bbox.left; p.x <= bbox.right; p.x++) {
-            bool should_sample=false;
-            microgl::ints::uint8_t blend=opacity;
-            if((w0|w1|w2)>=0) should_sample=true;
-            else if(antialias) { // cheap AA based on SDF
-                const rint distance = functions::min<rint>((w0_h), (w1_h), (w2_h));
-                // delta is at most 16 bits
-                rint delta = distance+max_distance_scaled_space_anti_alias;
-                bool perform_aa = (delta>=0) && (aa_all_edges || ((distance == (w0_h)) && aa_first_edge) ||
-                                               ((distance == (w1_h)) && aa_second_edge) ||
-                                               ((distance == (w2_h)) && aa_third_edge));
-                if (perform_aa) {
-                    should_sample = true; // 16+8=24 bits
-                    blend = functions::clamp<rint>((delta<<bits_distance_complement)>>P_AA, 0, 255);
-                    blend = (blend*opacity)>>8;
+    // hierarchical rasterization for big triangles. the edge functions are evaluated at the corners
+    // of 8x8 blocks, blocks outside of an edge are rejected, blocks inside all of the edges are filled
+    // without edge tests and anti-aliasing and the rest are tested per pixel, or clipped exactly per
+    // row with exact span clipping. smaller triangles are walked by rows, every row is a single block.
+    constexpr int block = 8;
+    const bool blocks = bbox.right-bbox.left>=(block<<1) && bbox.bottom-bbox.top>=(block<<1);
+    const int block_w = blocks ? block : bbox.right-bbox.left+1, block_h = blocks ? block : 1;
+    const rint_big aa_reject = -rint_big(max_distance_scaled_space_anti_alias);
+    const int pitch= _bitmap_canvas.stride();
+    // runs of pixels inside all of the edges are sampled as spans by span samplers, uvs of
+    // perspective correct triangles are not linear, so they are sampled per pixel
+    constexpr bool span_sampling = sampling::has_sample_span<Sampler>::value && !perspective_correct;
+    // with exact span clipping, all of the pixels of a row are inside all of the edges
+    const bool exact_spans = options_raster_spans() && !antialias;
+    color_t colors[span_sampling ? span_chunk() : 1];
+    // perspective subdivision, uvs are divided exactly at the ends of spans of (1<<span_bits) pixels,
+    // that are inside the triangle and interpolated linearly in between
+    const precision span_bits = perspective_correct ? renderingOptions()._2d_raster_bits_perspective_span : 0;
+    const int span_length = 1<<span_bits;
+    // uv of a pixel from its edge functions
+    auto uv_of = [&](const rint w0, const rint w1, const rint w2, rint & u_i, rint & v_i) {
+        u_i=0, v_i=0;
+        const auto pp = sub_pixel_precision;
+        // I compress down the weights to save some bits.
+        // bits=(bits_area_used+bits_used_max_uv) - sub_pixel_precision
+        rint w0_c=w0>>pp, w1_c=w1>>pp, w2_c=w2>>pp;
+        rint u_fixed = (w0_c*rint(u2)) + (w1_c*rint(u0)) + (w2_c*rint(u1));
+        rint v_fixed = (w0_c*rint(v2)) + (w1_c*rint(v0)) + (w2_c*rint(v1));
+        if(perspective_correct) { // compile-time branching
+            rint q_fixed = (w0_c*rint(q2)) +
+                           (w1_c*rint(q0)) + (w2_c*rint(q1));
+            rint q_compressed=q_fixed>>uv_precision; // this would not render with overflow detection
+            if(q_compressed) { // compression has a pitfall of producing zero
+                u_i = rint(u_fixed/q_compressed); v_i = rint(v_fixed/q_compressed);
+            }
+        } else {
+            if(divide) { // compile-time branching: division is stabler and is un-avoidable most of the time for pure 32 bit mode
+                rint aaa = w0_c+w1_c+w2_c;
+                if(aaa){
+                    u_i = (u_fixed)/aaa; v_i = (v_fixed)/aaa;
                 }
+            } else { // we use a temporary 64 bit and one_area to mimic division, this is FASTER even in 32 bits mode.
+//                u_fixed=u_fixed>>sub_pixel_precision;v_fixed=v_fixed>>sub_pixel_precision; // compress the bits, still is fine
+                rint_big u_fixed = rint_big(rint_big(w0)*rint_big(u2) + rint_big(w1)*rint_big(u0)+rint_big(w2)*rint_big(u1) )>>pp;
+                rint_big v_fixed = rint_big(rint_big(w0)*rint_big(v2) + rint_big(w1)*rint_big(v0)+rint_big(w2)*rint_big(v1) )>>pp;
+                u_i = rint_big(rint_big(u_fixed)*rint_big(one_area))>>(LL-pp);
+                v_i = rint_big(rint_big(v_fixed)*rint_big(one_area))>>(LL-pp);
             }
-            if(should_sample) {
-                rint u_i=0, v_i=0;
-                const auto pp = sub_pixel_precision;
-                // I compress down the weights to save some bits.
-                // bits=(bits_area_used+bits_used_max_uv) - sub_pixel_precision
-                rint w0_c=w0>>pp, w1_c=w1>>pp, w2_c=w2>>pp;
-                rint u_fixed = (w0_c*rint(u2)) + (w1_c*rint(u0)) + (w2_c*rint(u1));
-                rint v_fixed = (w0_c*rint(v2)) + (w1_c*rint(v0)) + (w2_c*rint(v1));
-                if(perspective_correct) { // compile-time branching
-                    rint q_fixed = (w0_c*rint(q2)) +
-                                   (w1_c*rint(q0)) + (w2_c*rint(q1));
-                    rint q_compressed=q_fixed>>uv_precision; // this would not render with overflow detection
-                    if(q_compressed) { // compression has a pitfall of producing zero
-                        u_i = rint(u_fixed/q_compressed); v_i = rint(v_fixed/q_compressed);
-                    }
+        }
+        u_i = functions::clamp<rint>(u_i, 0, (rint(1)<<uv_precision));
+        v_i = functions::clamp<rint>(v_i, 0, (rint(1)<<uv_precision));
+    };
+    for (p.y = bbox.top; p.y <= bbox.bottom; p.y+=block_h) {
+        const int bh = functions::min<int>(block_h, bbox.bottom-p.y+1);
+        rint w0_b=w0_row, w1_b=w1_row, w2_b=w2_row, w0_b_h=w0_row_h, w1_b_h=w1_row_h, w2_b_h=w2_row_h;
+        for (int bx = bbox.left; bx <= bbox.right; bx+=block_w, w0_b+=A01*block_w, w1_b+=A12*block_w,
+                w2_b+=A20*block_w, w0_b_h+=A01_h*block_w, w1_b_h+=A12_h*block_w, w2_b_h+=A20_h*block_w) {
+            const int bw = functions::min<int>(block_w, bbox.right-bx+1);
+            int span_from=0, span_to=bw-1;
+            bool edges=true;
+            if(blocks) {
+                rint_big min0, max0, min1, max1, min2, max2;
+                edgeBlockBounds(w0_b, A01, B01, bw, bh, min0, max0);
+                edgeBlockBounds(w1_b, A12, B12, bw, bh, min1, max1);
+                edgeBlockBounds(w2_b, A20, B20, bw, bh, min2, max2);
+                bool reject;
+                if(antialias) { // outside of an edge and outside of its anti-alias distance
+                    rint_big min0_h, max0_h, min1_h, max1_h, min2_h, max2_h;
+                    edgeBlockBounds(w0_b_h, A01_h, B01_h, bw, bh, min0_h, max0_h);
+                    edgeBlockBounds(w1_b_h, A12_h, B12_h, bw, bh, min1_h, max1_h);
+                    edgeBlockBounds(w2_b_h, A20_h, B20_h, bw, bh, min2_h, max2_h);
+                    reject = (max0<0 && max0_h<aa_reject) || (max1<0 && max1_h<aa_reject) ||
+                             (max2<0 && max2_h<aa_reject);
+                } else reject = max0<0 || max1<0 || max2<0;
+                if(reject) continue;
+                edges = !(min0>=0 && min1>=0 && min2>=0);
+            } else if(options_raster_spans()) { // compile-time branching
+                edges = !exact_spans;
+                if(antialias) { // everything inside the anti-alias distance, with one pixel of slack
+                    const rint_big threshold = aa_reject - (rint_big(1)<<P_AA);
+                    clipSpanToEdge(w0_b_h, A01_h, threshold, span_from, span_to);
+                    clipSpanToEdge(w1_b_h, A12_h, threshold, span_from, span_to);
+                    clipSpanToEdge(w2_b_h, A20_h, threshold, span_from, span_to);
                 } else {
-                    if(divide) { // compile-time branching: division is stabler and is un-avoidable most of the time for pure 32 bit mode
-                        rint aaa = w0_c+w1_c+w2_c;
-                        if(aaa){
-                            u_i = (u_fixed)/aaa; v_i = (v_fixed)/aaa;
+                    clipSpanToEdge(w0_b, A01, 0, span_from, span_to);
+                    clipSpanToEdge(w1_b, A12, 0, span_from, span_to);
+                    clipSpanToEdge(w2_b, A20, 0, span_from, span_to);
+                }
+            }
+            int index = p.y * pitch + bx;
+            rint w0_y=w0_b+A01*span_from, w1_y=w1_b+A12*span_from, w2_y=w2_b+A20*span_from;
+            rint w0_y_h=w0_b_h+A01_h*span_from, w1_y_h=w1_b_h+A12_h*span_from, w2_y_h=w2_b_h+A20_h*span_from;
+            for (int y = 0; y < bh; ++y, index+=pitch) {
+                int from=span_from, to=span_to;
+                bool row_edges=edges;
+                if(blocks && edges && exact_spans) { // rows of partially covered blocks are clipped exactly
+                    clipSpanToEdge(w0_y, A01, 0, from, to);
+                    clipSpanToEdge(w1_y, A12, 0, from, to);
+                    clipSpanToEdge(w2_y, A20, 0, from, to);
+                    row_edges=false;
+                }
+                if(span_sampling && !row_edges) {
+                    auto uv = [&](int k, int & u_, int & v_) {
+                        rint u_i, v_i;
+                        const int dk = k-span_from;
+                        uv_of(w0_y+A01*dk, w1_y+A12*dk, w2_y+A20*dk, u_i, v_i);
+                        u_=int(u_i); v_=int(v_i);
+                    };
+                    for (int x = from; x <= to; x+=span_chunk()) {
+                        const int count = functions::min<int>(span_chunk(), to-x+1);
+                        sampleSpan(sampler, uv, x, count, uv_precision, colors);
+                        blendSpan<BlendMode, PorterDuff, Sampler::rgba::a>(colors, nullptr, opacity, index + x, count, *this);
+                    }
+                    w0_y+=B01; w1_y+=B12; w2_y+=B20;
+                    continue;
+                }
+                const int dx=from-span_from;
+                rint w0=w0_y+A01*dx, w1=w1_y+A12*dx, w2=w2_y+A20*dx;
+                rint w0_h=w0_y_h+A01_h*dx, w1_h=w1_y_h+A12_h*dx, w2_h=w2_y_h+A20_h*dx;
+                int sub_start=0, sub_end=-1;
+                rint sub_u=0, sub_v=0, sub_du=0, sub_dv=0, end_u=0, end_v=0;
+                for (int x = from; x <= to; x++) {
+                    bool should_sample=false;
+                    microgl::ints::uint8_t blend=opacity;
+                    if(!row_edges || (w0|w1|w2)>=0) should_sample=true;
+                    else if(antialias) { // cheap AA based on SDF
+                        const rint distance = functions::min<rint>((w0_h), (w1_h), (w2_h));
+                        // delta is at most 16 bits
+                        rint delta = distance+max_distance_scaled_space_anti_alias;
+                        bool perform_aa = (delta>=0) && (aa_all_edges || ((distance == (w0_h)) && aa_first_edge) ||
+                                                       ((distance == (w1_h)) && aa_second_edge) ||
+                                                       ((distance == (w2_h)) && aa_third_edge));
+                        if (perform_aa) {
+                            should_sample = true; // 16+8=24 bits
+                            blend = functions::clamp<rint>((delta<<bits_distance_complement)>>P_AA, 0, 255);
+                            blend = (blend*opacity)>>8;
                         }
-                    } else { // we use a temporary 64 bit and one_area to mimic division, this is FASTER even in 32 bits mode.
-//                        u_fixed=u_fixed>>sub_pixel_precision;v_fixed=v_fixed>>sub_pixel_precision; // compress the bits, still is fine
-                        rint_big u_fixed = rint_big(rint_big(w0)*rint_big(u2) + rint_big(w1)*rint_big(u0)+rint_big(w2)*rint_big(u1) )>>pp;
-                        rint_big v_fixed = rint_big(rint_big(w0)*rint_big(v2) + rint_big(w1)*rint_big(v0)+rint_big(w2)*rint_big(v1) )>>pp;
-                        u_i = rint_big(rint_big(u_fixed)*rint_big(one_area))>>(LL-pp);
-                        v_i = rint_big(rint_big(v_fixed)*rint_big(one_area))>>(LL-pp);
                     }
+                    if(should_sample) {
+                        rint u_i, v_i;
+                        if(span_bits && x<sub_end) { // inside a span
+                            const rint k = x-sub_start;
+                            u_i = (sub_u + k*sub_du)>>span_bits; v_i = (sub_v + k*sub_dv)>>span_bits;
+                        } else if(span_bits) { // start a span at an exact uv
+                            if(x==sub_end) { u_i=end_u; v_i=end_v; }
+                            else uv_of(w0, w1, w2, u_i, v_i);
+                            const int length = functions::min<int>(span_length, to-x);
+                            const rint e0=w0+A01*length, e1=w1+A12*length, e2=w2+A20*length;
+                            sub_end=x;
+                            if(length>1 && (!row_edges || (e0|e1|e2)>=0)) { // the end is inside
+                                uv_of(e0, e1, e2, end_u, end_v);
+                                sub_start=x; sub_end=x+length;
+                                sub_u=u_i<<span_bits; sub_v=v_i<<span_bits;
+                                sub_du=length==span_length ? end_u-u_i : ((end_u-u_i)<<span_bits)/length;
+                                sub_dv=length==span_length ? end_v-v_i : ((end_v-v_i)<<span_bits)/length;
+                            }
+                        } else uv_of(w0, w1, w2, u_i, v_i);
+                        color_t col_bmp;
+                        sampler.sample(u_i, v_i, uv_precision, col_bmp);
+                        blendColor<BlendMode, PorterDuff, Sampler::rgba::a>(col_bmp, index + x, blend, *this);
+                    }
+                    w0+=A01; w1+=A12; w2+=A20;
+                    if(antialias) { w0_h+=A01_h; w1_h+=A12_h; w2_h+=A20_h; }
                 }
-                u_i = functions::clamp<rint>(u_i, 0, (rint(1)<<uv_precision));
-                v_i = functions::clamp<rint>(v_i, 0, (rint(1)<<uv_precision));
-                color_t col_bmp;
-                sampler.sample(u_i, v_i, uv_precision, col_bmp);
-                blendColor<BlendMode, PorterDuff, Sampler::rgba::a>(col_bmp, index + p.x, blend, *this);
+                w0_y+=B01; w1_y+=B12; w2_y+=B20;
+                if(antialias) { w0_y_h+=B01_h; w1_y_h+=B12_h; w2_y_h+=B20_h; }
             }
-            w0+=A01; w1+=A12; w2+=A20;
-            if(antialias) { w0_h+=A01_h; w1_h+=A12_h; w2_h+=A20_h; }
         }
-        w0_row+=B01; w1_row+=B12; w2_row+=B20;
-        if(antialias) { w0_row_h+=B01_h; w1_row_h+=B12_h; w2_row_h+=B20_h; }
+        w0_row+=B01*block_h; w1_row+=B12*block_h; w2_row+=B20*block_h;
+        if(antialias) { w0_row_h+=B01_h*block_h; w1_row_h+=B12_h*block_h; w2_row_h+=B20_h*block_h; }
     }
 }
 
@@ -1013,16 +1520,75 @@ void canvas<bitmap_type, options>::drawTriangle(Shader &shader,
                                            const shader_number<Shader>& depth_range_near,
                                            const shader_number<Shader>& depth_range_far) {
     static_assert_rgb<typename pixel_coder::rgba, shader_rgba<Shader>>();
+    // compute varying and positions per vertex for interpolation
+    shading::varying<Shader> varying_v0, varying_v1, varying_v2;
+    const auto v0_homo_space = shader.vertex(v0, varying_v0);
+    const auto v1_homo_space = shader.vertex(v1, varying_v1);
+    const auto v2_homo_space = shader.vertex(v2, varying_v2);
+    drawTriangle_shader_internal<BlendMode, PorterDuff, antialias, perspective_correct, depth_buffer_flag,
+            depth_pass::shade>(shader, viewport_width, viewport_height,
+            v0_homo_space, v1_homo_space, v2_homo_space, varying_v0, varying_v1, varying_v2,
+            opacity, culling, depth_buffer, depth_range_near, depth_range_far);
+}
+
+template<typename bitmap_type, microgl::ints::uint8_t options>
+template<typename BlendMode, typename PorterDuff, bool antialias, bool perspective_correct, bool depth_buffer_flag,
+        typename canvas<bitmap_type, options>::depth_pass pass, typename Shader, typename number,
+        typename depth_buffer_type>
+void canvas<bitmap_type, options>::drawTriangle_shader_internal(Shader &shader,
+                                           int viewport_width, int viewport_height,
+                                           const vertex4<number> & v0_homo_space,
+                                           const vertex4<number> & v1_homo_space,
+                                           const vertex4<number> & v2_homo_space,
+                                           const varying<Shader> & varying_v0,
+                                           const varying<Shader> & varying_v1,
+                                           const varying<Shader> & varying_v2,
+                                           const opacity_t opacity, const microtess::triangles::face_culling & culling,
+                                           depth_buffer_type *depth_buffer,
+                                           const shader_number<Shader>& depth_range_near,
+                                           const shader_number<Shader>& depth_range_far) {
 #define f microgl::math::to_fixed
     // this and drawTriangle_shader_homo_internal is the programmable 3d pipeline
-    // compute varying and positions per vertex for interpolation
     using varying = shading::varying<Shader>;
     using shader_number = shading::shader_number<Shader>;
-    varying varying_v0, varying_v1, varying_v2;
+    const auto & p0= v0_homo_space, & p1= v1_homo_space, & p2= v2_homo_space;
+    // outcodes of the clipping planes x+w, w-x, y+w, w-y, z+w and w-z. a triangle, whose vertices
+    // are all outside a plane is outside
+    const auto outcode = [](const vertex4<number> & v) -> unsigned {
+        return (v.x+v.w<0 ? 1u : 0u) | (v.w-v.x<0 ? 2u : 0u) | (v.y+v.w<0 ? 4u : 0u) |
+               (v.w-v.y<0 ? 8u : 0u) | (v.z+v.w<0 ? 16u : 0u) | (v.w-v.z<0 ? 32u : 0u);
+    };
+    const unsigned code0= outcode(p0), code1= outcode(p1), code2= outcode(p2);
+    if(code0 & code1 & code2) return;
+    // with all vertices in front of the eye, the determinant of their (x, y, w) rows has the sign of
+    // the area in normalized device coordinates, so back faces are culled before clipping. fixed point
+    // numbers skip it, since the cubic products may overflow them
+    const bool in_front= p0.w>0 && p1.w>0 && p2.w>0;
+    if(microgl::traits::is_float_point<number>() && in_front &&
+                            culling!=microtess::triangles::face_culling::none) {
+        const number det= p0.x*(p1.y*p2.w-p1.w*p2.y) - p0.y*(p1.x*p2.w-p1.w*p2.x) + p0.w*(p1.x*p2.y-p1.y*p2.x);
+        const bool ccw= det>0, cw= det<0;
+        if(ccw && culling==microtess::triangles::face_culling::ccw) return;
+        if(cw && culling==microtess::triangles::face_culling::cw) return;
+    }
+    // guard band, a triangle inside the near and far planes, whose vertices are inside the guard band
+    // is scissored by the rasterizer, so it is not clipped and its varying are not interpolated again
+    const number guard= number(guard_band());
+    const auto in_guard_band = [&guard](const vertex4<number> & v) -> bool {
+        const number extent= v.w*guard;
+        return v.x<=extent && -v.x<=extent && v.y<=extent && -v.y<=extent;
+    };
+    if(in_front && ((code0 | code1 | code2) & (16u|32u))==0 &&
+                in_guard_band(p0) && in_guard_band(p1) && in_guard_band(p2)) {
+        drawTriangle_shader_homo_internal<BlendMode, PorterDuff, antialias, perspective_correct, depth_buffer_flag,
+                pass, Shader, shader_number>(
+                shader, viewport_width, viewport_height,
+                p0, p1, p2,
+                varying_v0, varying_v1, varying_v2,
+                opacity, culling, depth_buffer, depth_range_near, depth_range_far);
+        return;
+    }
     varying varying_v0_clip, varying_v1_clip, varying_v2_clip;
-    auto v0_homo_space = shader.vertex(v0, varying_v0);
-    auto v1_homo_space = shader.vertex(v1, varying_v1);
-    auto v2_homo_space = shader.vertex(v2, varying_v2);
     // compute clipping in homogeneous 4D space
     using clipper= microgl::clipping::homo_triangle_clipper<shader_number>;
     typename clipper::vertices_list result_clipping;
@@ -1030,9 +1596,9 @@ void canvas<bitmap_type, options>::drawTriangle(Shader &shader,
     if(outside) return;
     const auto triangles= result_clipping.size()-2;
     for (unsigned ix=0; ix < triangles; ++ix) {
-        const auto & p0= result_clipping[0].point;
-        const auto & p1= result_clipping[ix+1].point;
-        const auto & p2= result_clipping[ix+2].point;
+        const auto & c0= result_clipping[0].point;
+        const auto & c1= result_clipping[ix+1].point;
+        const auto & c2= result_clipping[ix+2].point;
         const auto & bary_0= result_clipping[0].bary;
         const auto & bary_1= result_clipping[ix+1].bary;
         const auto & bary_2= result_clipping[ix+2].bary;
@@ -1045,9 +1611,9 @@ void canvas<bitmap_type, options>::drawTriangle(Shader &shader,
         varying_v1_clip.interpolate(varying_v0, varying_v1, varying_v2, bary_1_fixed);
         varying_v2_clip.interpolate(varying_v0, varying_v1, varying_v2, bary_2_fixed);
         drawTriangle_shader_homo_internal<BlendMode, PorterDuff, antialias, perspective_correct, depth_buffer_flag,
-                Shader, shader_number>(
+                pass, Shader, shader_number>(
                 shader, viewport_width, viewport_height,
-                p0, p1, p2,
+                c0, c1, c2,
                 varying_v0_clip, varying_v1_clip, varying_v2_clip,
                 opacity, culling, depth_buffer, depth_range_near, depth_range_far);
     }
@@ -1056,7 +1622,7 @@ void canvas<bitmap_type, options>::drawTriangle(Shader &shader,
 
 template<typename bitmap_type, microgl::ints::uint8_t options>
 template<typename BlendMode, typename PorterDuff, bool antialias, bool perspective_correct, bool depth_buffer_flag,
-        typename Shader, typename number, typename depth_buffer_type>
+        typename canvas<bitmap_type, options>::depth_pass pass, typename Shader, typename number, typename depth_buffer_type>
 void canvas<bitmap_type, options>::drawTriangle_shader_homo_internal(
         Shader & $shader,
         int viewport_width, int viewport_height,
@@ -1101,6 +1667,15 @@ void canvas<bitmap_type, options>::drawTriangle_shader_homo_internal(
     rint area = functions::orient2d<rint, rint_big>(v0_x, v0_y, v1_x, v1_y, v2_x, v2_y, sub_pixel_precision);
     rint one_over_w0_fixed= f(one_over_w0, w_bits), one_over_w1_fixed= f(one_over_w1, w_bits),
                                 one_over_w2_fixed= f(one_over_w2, w_bits);
+    // varying, that describe their layout are interpolated incrementally. the numerators and the
+    // denominator of the (perspective) weighted components are linear in raster space, so they
+    // are stepped along x with their gradients and divided per pixel, see shading::varying_layout
+    using layout = shading::varying_layout<varying>;
+    constexpr unsigned components = layout::components;
+    constexpr bool incremental = components>0 && microgl::traits::is_float_point<number>() &&
+            pass!=depth_pass::depth_only;
+    number weight_0= perspective_correct ? one_over_w0 : one, weight_1= perspective_correct ? one_over_w1 : one,
+            weight_2= perspective_correct ? one_over_w2 : one;
     /// overflow detection
     const auto bits_used_min_w=microgl::functions::used_integer_bits(microgl::functions::abs_min(
             one_over_w0_fixed, one_over_w1_fixed, one_over_w2_fixed));
@@ -1124,11 +1699,11 @@ void canvas<bitmap_type, options>::drawTriangle_shader_homo_internal(
         functions::swap(v1_x, v2_x); functions::swap(v1_y, v2_y);
         area = -area;
     } else { // flip vertically
-        functions::swap(varying_v1, varying_v2);
+        functions::swap(varying_v1, varying_v2); functions::swap(weight_1, weight_2);
         functions::swap(one_over_w1_fixed, one_over_w2_fixed); functions::swap(v1_z, v2_z);
     }
     // rotate to match edges
-    functions::swap(varying_v0, varying_v1);
+    functions::swap(varying_v0, varying_v1); functions::swap(weight_0, weight_1);
     functions::swap(one_over_w0_fixed, one_over_w1_fixed); functions::swap(v0_z, v1_z);
     // bounding box in raster space
 #define ceil_fixed(val, bits) ((val)&((1<<bits)-1) ? ((val>>bits)+1) : (val>>bits))
@@ -1143,6 +1718,15 @@ void canvas<bitmap_type, options>::drawTriangle_shader_homo_internal(
     if(bbox.empty()) return;
 #undef ceil_fixed
 #undef floor_fixed
+    // early depth rejection. depths of pixels are averages of the depths of the vertices, so a
+    // triangle, whose nearest vertex is behind the max depth of the tiles under it is hidden
+    const int z_left= bbox.left-_window.canvas_rect.left, z_top= bbox.top-_window.canvas_rect.top;
+    const rint_big z_min=functions::min<rint_big>(v0_z, v1_z, v2_z), z_max=functions::max<rint_big>(v0_z, v1_z, v2_z);
+    const bool hierarchical_z = depth_buffer_flag && z_min>=0 && z_max<=rint_big(zbuff.maxValue());
+    if(hierarchical_z && zbuff.occluded(z_left, z_top, z_left+bbox.right-bbox.left, z_top+bbox.bottom-bbox.top,
+                                        typename depth_buffer_type::value_type(z_min)))
+        return;
+    if(pass!=depth_pass::depth_only) _damage.add(bbox.left, bbox.top, bbox.right+1, bbox.bottom+1);
     // fill rules configurations
     microtess::triangles::top_left_t top_left =
             microtess::triangles::classifyTopLeftEdges(false,
@@ -1165,41 +1749,131 @@ void canvas<bitmap_type, options>::drawTriangle_shader_homo_internal(
     // Triangle setup, this needs at least (P+1) bits, since the delta is always <= length
     rint A01 = v0_y-v1_y, A12 = v1_y-v2_y, A20 = v2_y-v0_y;
     rint B01 = v1_x-v0_x, B12 = v2_x-v1_x, B20 = v0_x-v2_x;
-    const int pitch= width(); int index = p.y * pitch;
-    for (p.y = bbox.top; p.y <= bbox.bottom; p.y++, index+=pitch, b0_row+=B01, b1_row+=B12, b2_row+=B20) {
-        rint b0 = b0_row, b1 = b1_row, b2 = b2_row;
-        for (p.x = bbox.left; p.x<=bbox.right; p.x++, b0+=A01, b1+=A12, b2+=A20) {
-            // closure test with full sub pixel precision
-            const bool in_closure= (b0 | b1 | b2) >= 0;
-            bool should_sample= in_closure;
-            auto opacity_sample = opacity;
-            rint b0_c = b0>>sub_pixel_precision, b1_c = b1>>sub_pixel_precision, b2_c = b2>>sub_pixel_precision;
-            rint area_c = b0_c + b1_c + b2_c;
-            if(!area_c) continue; // compression can cause zero area
-            auto bary = vertex4<rint>{b0_c, b1_c, b2_c, area_c};
-            if(in_closure && perspective_correct) { // compute perspective-correct and transform to sub-pixel-space
-                // compress bits
-                bary.x= (b0_c * one_over_w0_fixed) >> bits_used_min_w;
-                bary.y= (b1_c * one_over_w1_fixed) >> bits_used_min_w;
-                bary.z= (b2_c * one_over_w2_fixed) >> bits_used_min_w;
-                bary.w=bary.x+bary.y+bary.z;
-                if(bary.w==0) bary={1, 1, 1, 3};
+    // hierarchical rasterization in 8x8 blocks for big triangles, see drawTriangle_internal
+    constexpr int block = 8;
+    const bool blocks = bbox.right-bbox.left>=(block<<1) && bbox.bottom-bbox.top>=(block<<1);
+    const int block_w = blocks ? block : bbox.right-bbox.left+1, block_h = blocks ? block : 1;
+    const int pitch= _bitmap_canvas.stride();
+    // the depth buffer has the size of the bitmap, but not necessarily its stride
+    const int z_pitch= depth_buffer_flag ? zbuff.width() : 0;
+    // the depth plane (z_n/z_d), z_d is the same for all of the pixels. depths of pixels are computed
+    // with compressed barycentric weights, that are off the plane by less than z_slack
+    const rint_big z_d = rint_big(b0_row)+b1_row+b2_row;
+    const rint_big z_a = rint_big(v0_z)*A01+rint_big(v1_z)*A12+rint_big(v2_z)*A20;
+    const rint_big z_b = rint_big(v0_z)*B01+rint_big(v1_z)*B12+rint_big(v2_z)*B20;
+    const rint_big z_slack = z_d>0 ? ((3*(z_max-z_min))<<sub_pixel_precision)/z_d+2 : 0;
+    // weighted components of the vertices and the gradients along x of the numerators and the
+    // denominator. without perspective, the denominator is the constant sum of the edge functions
+    constexpr unsigned slots = components ? components : 1;
+    number c0[slots], c1[slots], c2[slots], numerator_dx[slots], numerator[slots];
+    const number denominator_dx = weight_0*number(A01)+weight_1*number(A12)+weight_2*number(A20);
+    const number affine_inverse = perspective_correct ? one :
+            one/(number(b0_row)+number(b1_row)+number(b2_row));
+    for (unsigned k = 0; incremental && k < components; ++k) {
+        c0[k]=layout::template get<number>(varying_v0, k)*weight_0;
+        c1[k]=layout::template get<number>(varying_v1, k)*weight_1;
+        c2[k]=layout::template get<number>(varying_v2, k)*weight_2;
+        numerator_dx[k]=c0[k]*number(A01)+c1[k]*number(A12)+c2[k]*number(A20);
+    }
+    for (p.y = bbox.top; p.y <= bbox.bottom; p.y+=block_h, b0_row+=B01*block_h, b1_row+=B12*block_h, b2_row+=B20*block_h) {
+        const int bh = functions::min<int>(block_h, bbox.bottom-p.y+1);
+        rint b0_b=b0_row, b1_b=b1_row, b2_b=b2_row;
+        for (int bx = bbox.left; bx <= bbox.right; bx+=block_w, b0_b+=A01*block_w, b1_b+=A12*block_w, b2_b+=A20*block_w) {
+            const int bw = functions::min<int>(block_w, bbox.right-bx+1);
+            int span_from=0, span_to=bw-1;
+            bool edges=true;
+            if(blocks) {
+                rint_big min0, max0, min1, max1, min2, max2;
+                edgeBlockBounds(b0_b, A01, B01, bw, bh, min0, max0);
+                edgeBlockBounds(b1_b, A12, B12, bw, bh, min1, max1);
+                edgeBlockBounds(b2_b, A20, B20, bw, bh, min2, max2);
+                if(max0<0 || max1<0 || max2<0) continue;
+                edges = !(min0>=0 && min1>=0 && min2>=0);
+                if(hierarchical_z && z_d>0) { // reject the block, if the nearest depth of the plane is hidden
+                    rint_big z_n_min, z_n_max;
+                    const rint_big z_n = rint_big(v0_z)*b0_b+rint_big(v1_z)*b1_b+rint_big(v2_z)*b2_b;
+                    edgeBlockBounds(z_n, z_a, z_b, bw, bh, z_n_min, z_n_max);
+                    const rint_big z_block = functions::max<rint_big>(z_n_min/z_d-z_slack, z_min);
+                    const int zx = bx-_window.canvas_rect.left, zy = p.y-_window.canvas_rect.top;
+                    if(z_block<=z_max && zbuff.occluded(zx, zy, zx+bw-1, zy+bh-1,
+                                                        typename depth_buffer_type::value_type(z_block)))
+                        continue;
+                }
+            } else if(options_raster_spans()) { // compile-time branching
+                clipSpanToEdge(b0_b, A01, 0, span_from, span_to);
+                clipSpanToEdge(b1_b, A12, 0, span_from, span_to);
+                clipSpanToEdge(b2_b, A20, 0, span_from, span_to);
             }
-            if(depth_buffer_flag && should_sample) {
-                using z_type=typename depth_buffer_type::value_type;
-                constexpr bool use_fpu=microgl::traits::is_float_point<number>(); // compile-time flag
-                rint denom= rint(v0_z) * b0_c + rint(v1_z) * b1_c + rint(v2_z) * b2_c;
-                z_type z=use_fpu ? z_type(number(denom)/area_c) : denom/area_c;
-                const int z_index = index-_window.index_correction+p.x;
-                if((z>zbuff[z_index])) should_sample=false;
-                else zbuff[z_index]=z;
+            bool z_written = false;
+            int index = p.y * pitch + bx;
+            int z_row = (p.y-_window.canvas_rect.top) * z_pitch + bx-_window.canvas_rect.left;
+            rint b0_y=b0_b+A01*span_from, b1_y=b1_b+A12*span_from, b2_y=b2_b+A20*span_from;
+            for (int y = 0; y < bh; ++y, index+=pitch, z_row+=z_pitch, b0_y+=B01, b1_y+=B12, b2_y+=B20) {
+                int from=span_from, to=span_to;
+                bool row_edges=edges;
+                if(options_raster_spans() && blocks && edges) { // rows of partially covered blocks are clipped exactly
+                    clipSpanToEdge(b0_y, A01, 0, from, to);
+                    clipSpanToEdge(b1_y, A12, 0, from, to);
+                    clipSpanToEdge(b2_y, A20, 0, from, to);
+                    row_edges=false;
+                }
+                const int dx=from-span_from;
+                rint b0 = b0_y+A01*dx, b1 = b1_y+A12*dx, b2 = b2_y+A20*dx;
+                number denominator{0};
+                if(incremental) { // start a step before the span, the loop steps first
+                    const number e0 = number(b0), e1 = number(b1), e2 = number(b2);
+                    denominator = weight_0*e0+weight_1*e1+weight_2*e2-denominator_dx;
+                    for (unsigned k = 0; k < components; ++k)
+                        numerator[k]=c0[k]*e0+c1[k]*e1+c2[k]*e2-numerator_dx[k];
+                }
+                for (int x = from; x<=to; x++, b0+=A01, b1+=A12, b2+=A20) {
+                    if(incremental) {
+                        denominator+=denominator_dx;
+                        for (unsigned k = 0; k < components; ++k) numerator[k]+=numerator_dx[k];
+                    }
+                    // closure test with full sub pixel precision
+                    const bool in_closure= !row_edges || (b0 | b1 | b2) >= 0;
+                    bool should_sample= in_closure;
+                    auto opacity_sample = opacity;
+                    rint b0_c = b0>>sub_pixel_precision, b1_c = b1>>sub_pixel_precision, b2_c = b2>>sub_pixel_precision;
+                    rint area_c = b0_c + b1_c + b2_c;
+                    if(!area_c) continue; // compression can cause zero area
+                    auto bary = vertex4<rint>{b0_c, b1_c, b2_c, area_c};
+                    if(in_closure && perspective_correct && !incremental && pass!=depth_pass::depth_only) { // compute perspective-correct and transform to sub-pixel-space
+                        // compress bits
+                        bary.x= (b0_c * one_over_w0_fixed) >> bits_used_min_w;
+                        bary.y= (b1_c * one_over_w1_fixed) >> bits_used_min_w;
+                        bary.z= (b2_c * one_over_w2_fixed) >> bits_used_min_w;
+                        bary.w=bary.x+bary.y+bary.z;
+                        if(bary.w==0) bary={1, 1, 1, 3};
+                    }
+                    if(depth_buffer_flag && should_sample) {
+                        using z_type=typename depth_buffer_type::value_type;
+                        constexpr bool use_fpu=microgl::traits::is_float_point<number>(); // compile-time flag
+                        rint denom= rint(v0_z) * b0_c + rint(v1_z) * b1_c + rint(v2_z) * b2_c;
+                        z_type z=use_fpu ? z_type(number(denom)/area_c) : denom/area_c;
+                        const int z_index = z_row+x;
+                        if(pass==depth_pass::shade_equal) should_sample = z==zbuff[z_index];
+                        else if((z>zbuff[z_index])) should_sample=false;
+                        else { zbuff[z_index]=z; z_written=true; }
+                    }
+                    if(should_sample && pass!=depth_pass::depth_only) {
+                        // cast to user's number types vertex4<number> casted_bary= bary;, I decided to stick with l64
+                        // because other wise this would have wasted bits for Q types although it would have been more elegant.
+                        if(incremental) {
+                            const number inverse = perspective_correct ?
+                                    (denominator>0 ? one/denominator : number(0)) : affine_inverse;
+                            for (unsigned k = 0; k < components; ++k)
+                                layout::set(interpolated_varying, k, numerator[k]*inverse);
+                        } else interpolated_varying.interpolate(varying_v0, varying_v1, varying_v2, bary);
+                        auto color = $shader.fragment(interpolated_varying);
+                        blendColor<BlendMode, PorterDuff, shader_type::rgba::a>(color, index + x, opacity_sample, *this);
+                    }
+                }
             }
-            if(should_sample) {
-                // cast to user's number types vertex4<number> casted_bary= bary;, I decided to stick with l64
-                // because other wise this would have wasted bits for Q types although it would have been more elegant.
-                interpolated_varying.interpolate(varying_v0, varying_v1, varying_v2, bary);
-                auto color = $shader.fragment(interpolated_varying);
-                blendColor<BlendMode, PorterDuff, shader_type::rgba::a>(color, index + p.x, opacity_sample, *this);
+            if(z_written) {
+                const int zx = bx-_window.canvas_rect.left, zy = p.y-_window.canvas_rect.top;
+                zbuff.invalidateTiles(zx, zy, zx+bw-1, zy+bh-1);
             }
         }
     }
@@ -1243,12 +1917,12 @@ void canvas<bitmap_type, options>::drawMask_internal(const masks::chrome_mode &m
     if(effectiveRect.empty()) return;
 #define ceil_fixed(val, bits) ((val)&((1<<bits)-1) ? ((val>>bits)+1) : (val>>bits))
 #define floor_fixed(val, bits) (val>>bits)
-    color_t col_bmp{};
     const precision p= sub_pixel_precision;
     const rect bbox_r = {floor_fixed(left, p), floor_fixed(top, p),
                          ceil_fixed(right, p)-1, ceil_fixed(bottom, p)-1};
     const rect bbox_r_c = bbox_r.intersect(effectiveRect);
     if(bbox_r_c.empty()) return;
+    _damage.add(bbox_r_c.left, bbox_r_c.top, bbox_r_c.right+1, bbox_r_c.bottom+1);
 #undef ceil_fixed
 #undef floor_fixed
     // calculate original uv deltas, this way we can always accurately predict blocks
@@ -1267,13 +1941,19 @@ void canvas<bitmap_type, options>::drawMask_internal(const masks::chrome_mode &m
     const int du= (u1-u0)/bbox_r.width(); // this occupies (boost_bits=14) bits
     const int dv = (v1-v0)/bbox_r.height(); // this occupies (boost_bits=14) bits
     const int dx= bbox_r_c.left-bbox_r.left, dy= bbox_r_c.top-bbox_r.top;
-    const int u_start= u0+(du>>1)+dx*du, pitch= width();
+    const int u_start= u0+(du>>1)+dx*du, pitch= _bitmap_canvas.stride();
     int index= bbox_r_c.top * pitch;
     constexpr bits alpha_bits = pixel_coder::rgba::a ? pixel_coder::rgba::a : 8;
     constexpr channel_t max_alpha_value = (microgl::ints::uint16_t(1)<<alpha_bits) - 1;
+    color_t colors[span_chunk()];
     for (int y=bbox_r_c.top, v=v0+(du>>1)+dy*dv; y<=bbox_r_c.bottom; y++, v+=dv, index+=pitch) {
-        for (int x=bbox_r_c.left, u=u_start; x<=bbox_r_c.right; x++, u+=du) {
-            sampler.sample(u>>boost_u, v>>boost_v, uv_precision, col_bmp);
+        auto uv = [&](int k, int & u_, int & v_) { u_=(u_start+k*du)>>boost_u; v_=v>>boost_v; };
+        for (int x=bbox_r_c.left; x<=bbox_r_c.right; x++) {
+            const int k = x-bbox_r_c.left, chunk_ix = k%span_chunk();
+            if(chunk_ix==0)
+                sampleSpan(sampler, uv, k, functions::min<int>(span_chunk(), bbox_r_c.right-x+1),
+                           uv_precision, colors);
+            color_t & col_bmp = colors[chunk_ix];
             channel_t a=0;
             switch (mode) {
                 case masks::chrome_mode::red_channel:
@@ -1386,7 +2066,7 @@ void canvas<bitmap_type, options>::drawPolygon(const Sampler &sampler,
 //            indices.size(),
             type,
             opacity,
-            u0, v0, u1, v1);
+            u0, v0, u1, v1, allocator);
 
     if(debug)
         drawTrianglesWireframe({0,0,0,255},
@@ -1427,7 +2107,7 @@ void canvas<bitmap_type, options>::drawPathStroke(const Sampler &sampler,
             buffers.output_indices.size(),
             buffers.output_indices_type,
             opacity,
-            u0, v0, u1, v1);
+            u0, v0, u1, v1, path.get_allocator());
     if(debug)
         drawTrianglesWireframe({0, 0, 0, 255}, transform,
                                buffers.output_vertices.data(),
@@ -1450,10 +2130,21 @@ void canvas<bitmap_type, options>::drawPathFill(const Sampler &sampler,
                                            const microtess::tess_quality &quality,
                                            opacity_t opacity,
                                            const number2 u0, const number2 v0,
-                                           const number2 u1, const number2 v1) {
+                                           const number2 u1, const number2 v1,
+                                           fill_engine engine) {
     constexpr bool void_sampler = microgl::traits::is_same<Sampler, microgl::sampling::void_sampler>::value;
     static_assert_rgb<typename pixel_coder::rgba, typename Sampler::rgba, void_sampler>();
     if(void_sampler) return;
+    if(engine==fill_engine::scanline) {
+        drawPathFill_scanline<BlendMode, PorterDuff, antialias, number1, number2>(sampler, transform, path,
+                rule, opacity, u0, v0, u1, v1);
+        return;
+    }
+    if(engine==fill_engine::stencil) {
+        drawPathFill_stencil<BlendMode, PorterDuff, number1, number2>(sampler, transform, path,
+                rule, opacity, u0, v0, u1, v1);
+        return;
+    }
     const auto & buffers= path.tessellateFill(rule, quality,
             antialias, debug);
     if(buffers.output_vertices.size()==0) return;
@@ -1466,7 +2157,7 @@ void canvas<bitmap_type, options>::drawPathFill(const Sampler &sampler,
             buffers.output_indices.size(),
             buffers.output_indices_type,
             opacity,
-            u0, v0, u1, v1);
+            u0, v0, u1, v1, path.get_allocator());
     if(debug) {
         drawTrianglesWireframe({0,0,0,255}, transform,
                                buffers.output_vertices.data(),
@@ -1479,6 +2170,289 @@ void canvas<bitmap_type, options>::drawPathFill(const Sampler &sampler,
     }
 }
 
+template<typename bitmap_type, microgl::ints::uint8_t options>
+template <typename BlendMode, typename PorterDuff, bool antialias,
+          typename number1, typename number2,
+          typename Sampler, template<typename...> class path_container_template,
+          class tessellation_allocator>
+void canvas<bitmap_type, options>::drawPathFill_scanline(const Sampler &sampler,
+                                           const matrix_3x3<number1> &transform,
+                                           microtess::path<number1, path_container_template, tessellation_allocator> & path,
+                                           const microtess::fill_rule &rule, opacity_t opacity,
+                                           const number2 u0, const number2 v0,
+                                           const number2 u1, const number2 v1) {
+    const auto effectiveRect = calculateEffectiveDrawRect();
+    if(effectiveRect.empty() || opacity==0) return;
+#define f microgl::math::to_fixed
+    // coverage is computed with 8 bits of sub-pixel precision, the area of a pixel is (2*one*one)
+    constexpr precision p = 8;
+    constexpr int one = 1<<p;
+    const precision uv_p = renderingOptions()._2d_raster_bits_uv;
+    const int paths = path.subpathsCount();
+    int size = 0;
+    for (int ix = 0; ix < paths; ++ix) size += int(path.getSubPath(ix).size());
+    if(size<3) return;
+    using int_allocator = typename tessellation_allocator::template rebind<int>::other;
+    int_allocator allocator(path.get_allocator());
+    // transform the vertices into fixed point canvas space
+    int * points = allocator.allocate(size*2);
+    vertex2<number1> min, max;
+    int min_x=0, min_y=0, max_x=0, max_y=0;
+    for (int ix = 0, jx = 0; ix < paths; ++ix) {
+        const auto sub_path = path.getSubPath(ix);
+        for (int kx = 0; kx < int(sub_path.size()); ++kx, jx+=2) {
+            const auto & pt = sub_path[kx];
+            const auto tp = transform*pt;
+            const int x = f(tp.x, p), y = f(tp.y, p);
+            points[jx]=x; points[jx+1]=y;
+            if(jx==0) { min=max=pt; min_x=max_x=x; min_y=max_y=y; continue; }
+            if(pt.x<min.x) min.x=pt.x;
+            if(pt.y<min.y) min.y=pt.y;
+            if(pt.x>max.x) max.x=pt.x;
+            if(pt.y>max.y) max.y=pt.y;
+            if(x<min_x) min_x=x;
+            if(y<min_y) min_y=y;
+            if(x>max_x) max_x=x;
+            if(y>max_y) max_y=y;
+        }
+    }
+    const path_uv_map uvs(transform, min, max, u0, v0, u1, v1, uv_p);
+    // pixels, that the path may cover, right/bottom exclusive
+    const rect bbox = rect{min_x>>p, min_y>>p, (max_x>>p)+1, (max_y>>p)+1}.intersect(
+            {effectiveRect.left, effectiveRect.top, effectiveRect.right+1, effectiveRect.bottom+1});
+    if(bbox.empty() || uvs.degenerate()) { allocator.deallocate(points, size*2); return; }
+    _damage.add(bbox);
+    // a row has a cell per pixel and another cell, that takes the carry of the last pixel
+    const int width = bbox.width(), row_cells = width+1, right_side = width<<p, left_fixed = bbox.left<<p;
+    const int band_rows = functions::min<int>(functions::max<int>(1, path_fill_cells()/row_cells), bbox.height());
+    int * cells = allocator.allocate(band_rows*row_cells);
+    for (int ix = 0; ix < band_rows*row_cells; ++ix) cells[ix]=0;
+    int band_top=0, band_bottom=0;
+    // add the signed area of a line, that is inside a row, to the cells it crosses, a cell gets the
+    // area right of the line inside the cell and the next cell gets the rest
+    auto accumulate = [&](int * row, int xs, int ys, int xe, int ye, int dir) {
+        if(xs==xe) {
+            const int c = functions::min<int>(xs>>p, width-1), fx = xs-(c<<p), dy = dir*(ye-ys);
+            row[c] += dy*(2*one-2*fx); row[c+1] += dy*2*fx;
+            return;
+        }
+        const int dx = xe-xs;
+        for (int x=xs, y=ys; x!=xe;) {
+            int c, x_next;
+            if(dx>0) { c=x>>p; x_next=functions::min<int>((c+1)<<p, xe); }
+            else { c=(x-1)>>p; x_next=functions::max<int>(c<<p, xe); }
+            const int y_next = x_next==xe ? ye : ys+int(rint_big(x_next-xs)*(ye-ys)/dx);
+            const int fa = x-(c<<p), fb = x_next-(c<<p), dy = dir*(y_next-y);
+            row[c] += dy*(2*one-fa-fb); row[c+1] += dy*(fa+fb);
+            x=x_next; y=y_next;
+        }
+    };
+    auto edge = [&](int x0, int y0, int x1, int y1) {
+        if(y0==y1) return;
+        int dir=1;
+        if(y0>y1) { functions::swap(x0, x1); functions::swap(y0, y1); dir=-1; }
+        if(y1<=band_top || y0>=band_bottom) return;
+        x0-=left_fixed; x1-=left_fixed;
+        // split where the edge crosses the sides, parts left of the buffer become vertical
+        // on its left side, parts right of it do not cover any pixel
+        int splits[4]={y0}, count=1;
+        const int sides[2] = {x0<x1 ? 0 : right_side, x0<x1 ? right_side : 0};
+        for (int ix = 0; ix < 2; ++ix) {
+            if(sides[ix]>functions::min(x0, x1) && sides[ix]<functions::max(x0, x1))
+                splits[count++] = y0+int(rint_big(sides[ix]-x0)*(y1-y0)/(x1-x0));
+        }
+        splits[count++]=y1;
+        for (int ix = 0; ix < count-1; ++ix) {
+            const int top=functions::max(splits[ix], band_top), bottom=functions::min(splits[ix+1], band_bottom);
+            for (int y=top; y<bottom;) {
+                const int y_next = functions::min(((y>>p)+1)<<p, bottom);
+                const int xs = functions::clamp<int>(x0+int(rint_big(x1-x0)*(y-y0)/(y1-y0)), 0, right_side);
+                const int xe = functions::clamp<int>(x0+int(rint_big(x1-x0)*(y_next-y0)/(y1-y0)), 0, right_side);
+                if(xs!=right_side || xe!=right_side)
+                    accumulate(cells+((y-band_top)>>p)*row_cells, xs, y, xe, y_next, dir);
+                y=y_next;
+            }
+        }
+    };
+    const int pitch = _bitmap_canvas.stride();
+    color_t colors[span_chunk()];
+    opacity_t coverage[span_chunk()];
+    for (int band = bbox.top; band < bbox.bottom; band+=band_rows) {
+        const int rows = functions::min(band_rows, bbox.bottom-band);
+        band_top=band<<p; band_bottom=(band+rows)<<p;
+        for (int ix = 0, jx = 0; ix < paths; ++ix) { // sub paths are closed implicitly
+            const int count = int(path.getSubPath(ix).size());
+            for (int kx = 0; kx < count; ++kx) {
+                const int * a = points+jx+2*kx, * b = points+jx+2*((kx+1)%count);
+                edge(a[0], a[1], b[0], b[1]);
+            }
+            jx+=2*count;
+        }
+        for (int r = 0; r < rows; ++r) {
+            int * row = cells+r*row_cells;
+            // the running sum is the winding weighted by the covered area, turn it into coverage
+            int winding=0;
+            for (int x = 0; x < width; ++x) {
+                winding+=row[x];
+                int a = winding<0 ? -winding : winding;
+                if(rule==microtess::fill_rule::even_odd) {
+                    a &= (1<<(2*p+2))-1;
+                    if(a>(2*one*one)) a = (4*one*one)-a;
+                }
+                a >>= 2*p+1-8;
+                if(a>255) a=255;
+                if(!antialias) a = a>=128 ? 255 : 0;
+                row[x]=a;
+            }
+            row[width]=0;
+            const int y = band+r, index = y*pitch+bbox.left;
+            auto uv = [&](int k, int & u_, int & v_) { uvs(bbox.left+k, y, u_, v_); };
+            for (int x = 0; x < width;) {
+                if(row[x]==0) { ++x; continue; }
+                int count=0;
+                for (; count<span_chunk() && x+count<width && row[x+count]; ++count) {
+                    coverage[count]=opacity_t((row[x+count]*opacity*257+257)>>16);
+                    row[x+count]=0;
+                }
+                sampleSpan(sampler, uv, x, count, uv_p, colors);
+                blendSpan<BlendMode, PorterDuff, Sampler::rgba::a>(colors, coverage, opacity, index+x, count, *this);
+                x+=count;
+            }
+        }
+    }
+    allocator.deallocate(cells, band_rows*row_cells);
+    allocator.deallocate(points, size*2);
+#undef f
+}
+
+template<typename bitmap_type, microgl::ints::uint8_t options>
+template <typename BlendMode, typename PorterDuff,
+          typename number1, typename number2,
+          typename Sampler, template<typename...> class path_container_template,
+          class tessellation_allocator>
+void canvas<bitmap_type, options>::drawPathFill_stencil(const Sampler &sampler,
+                                           const matrix_3x3<number1> &transform,
+                                           microtess::path<number1, path_container_template, tessellation_allocator> & path,
+                                           const microtess::fill_rule &rule, opacity_t opacity,
+                                           const number2 u0, const number2 v0,
+                                           const number2 u1, const number2 v1) {
+    const auto effectiveRect = calculateEffectiveDrawRect();
+    if(effectiveRect.empty() || opacity==0) return;
+#define f microgl::math::to_fixed
+    const precision p = renderingOptions()._2d_raster_bits_sub_pixel;
+    const precision uv_p = renderingOptions()._2d_raster_bits_uv;
+    const int paths = path.subpathsCount();
+    vertex2<number1> min, max;
+    int min_x=0, min_y=0, max_x=0, max_y=0;
+    bool first=true;
+    for (int ix = 0; ix < paths; ++ix) { // bounding boxes of the path and of the transformed path
+        const auto sub_path = path.getSubPath(ix);
+        for (int kx = 0; kx < int(sub_path.size()); ++kx) {
+            const auto & pt = sub_path[kx];
+            const auto tp = transform*pt;
+            const int x = f(tp.x, p), y = f(tp.y, p);
+            if(first) { min=max=pt; min_x=max_x=x; min_y=max_y=y; first=false; continue; }
+            if(pt.x<min.x) min.x=pt.x;
+            if(pt.y<min.y) min.y=pt.y;
+            if(pt.x>max.x) max.x=pt.x;
+            if(pt.y>max.y) max.y=pt.y;
+            if(x<min_x) min_x=x;
+            if(y<min_y) min_y=y;
+            if(x>max_x) max_x=x;
+            if(y>max_y) max_y=y;
+        }
+    }
+    if(first) return;
+    const path_uv_map uvs(transform, min, max, u0, v0, u1, v1, uv_p);
+    // pixels, that the path may cover, right/bottom exclusive
+    const rect bbox = rect{min_x>>p, min_y>>p, (max_x>>p)+1, (max_y>>p)+1}.intersect(
+            {effectiveRect.left, effectiveRect.top, effectiveRect.right+1, effectiveRect.bottom+1});
+    if(bbox.empty() || uvs.degenerate()) return;
+    _damage.add(bbox);
+    // count the winding of the pixels with a triangle fan of every sub path, counter clockwise
+    // triangles decrement, so pixels outside of a sub path sum to zero
+    stencil_buffer<tessellation_allocator> stencil(bbox.width(), bbox.height(), path.get_allocator());
+    for (int ix = 0; ix < paths; ++ix) {
+        const auto sub_path = path.getSubPath(ix);
+        const int count = int(sub_path.size());
+        if(count<3) continue;
+        const auto p0 = transform*sub_path[0];
+        const int x0 = f(p0.x, p), y0 = f(p0.y, p);
+        auto p1 = transform*sub_path[1];
+        int x1 = f(p1.x, p), y1 = f(p1.y, p);
+        for (int kx = 2; kx < count; ++kx) {
+            const auto p2 = transform*sub_path[kx];
+            const int x2 = f(p2.x, p), y2 = f(p2.y, p);
+            stencilTriangle_internal(stencil, bbox, x0, y0, x1, y1, x2, y2, p);
+            x1=x2; y1=y2;
+        }
+    }
+    // cover the pixels, that pass the fill rule
+    const bool even_odd = rule==microtess::fill_rule::even_odd;
+    const int pitch = _bitmap_canvas.stride(), width = bbox.width();
+    color_t colors[span_chunk()];
+    for (int y = bbox.top; y < bbox.bottom; ++y) {
+        const auto * row = stencil.data() + (y-bbox.top)*width;
+        const int index = y*pitch+bbox.left;
+        auto uv = [&](int k, int & u_, int & v_) { uvs(bbox.left+k, y, u_, v_); };
+        for (int x = 0; x < width;) {
+            if(!(even_odd ? row[x]&1 : row[x])) { ++x; continue; }
+            int count=1;
+            while (count<span_chunk() && x+count<width && (even_odd ? row[x+count]&1 : row[x+count])) ++count;
+            sampleSpan(sampler, uv, x, count, uv_p, colors);
+            blendSpan<BlendMode, PorterDuff, Sampler::rgba::a>(colors, nullptr, opacity, index+x, count, *this);
+            x+=count;
+        }
+    }
+#undef f
+}
+
+template<typename bitmap_type, microgl::ints::uint8_t options>
+template<class stencil_type>
+void canvas<bitmap_type, options>::stencilTriangle_internal(stencil_type & stencil, const rect & stencil_rect,
+                                                            int v0_x, int v0_y, int v1_x, int v1_y,
+                                                            int v2_x, int v2_y, precision sub_pixel_precision) {
+    using value_type = typename stencil_type::value_type;
+    const rint_big area = functions::orient2d<int, rint_big>(v0_x, v0_y, v1_x, v1_y, v2_x, v2_y, 0);
+    if(area==0) return;
+    value_type step = 1;
+    if(area<0) { // convert CCW to CW triangle, that decrements
+        functions::swap(v1_x, v2_x); functions::swap(v1_y, v2_y);
+        step = value_type(~value_type(0));
+    }
+#define ceil_fixed(val, bits) ((val)&((1<<bits)-1) ? ((val>>bits)+1) : (val>>bits))
+#define floor_fixed(val, bits) ((val)>>bits)
+    const precision p = sub_pixel_precision;
+    rect bbox = {floor_fixed(functions::min<int>(v0_x, v1_x, v2_x), p),
+                 floor_fixed(functions::min<int>(v0_y, v1_y, v2_y), p),
+                 ceil_fixed(functions::max<int>(v0_x, v1_x, v2_x), p)+1,
+                 ceil_fixed(functions::max<int>(v0_y, v1_y, v2_y), p)+1};
+    bbox = bbox.intersect(stencil_rect);
+    if(bbox.empty()) return;
+#undef ceil_fixed
+#undef floor_fixed
+    microtess::triangles::top_left_t top_left = // fill rules adjustments
+            microtess::triangles::classifyTopLeftEdges<rint>(false, v0_x, v0_y, v1_x, v1_y, v2_x, v2_y);
+    const int bias_w0=top_left.first?0:-1, bias_w1=top_left.second?0:-1, bias_w2=top_left.third?0:-1;
+    // edge functions at the center of the top left pixel
+    const int half = (1<<p)>>1;
+    const int c_x = (bbox.left<<p)+half, c_y = (bbox.top<<p)+half;
+    rint_big w0_row = (functions::orient2d<int, rint_big>(v0_x,v0_y, v1_x,v1_y, c_x,c_y, 0) + bias_w0)>>p;
+    rint_big w1_row = (functions::orient2d<int, rint_big>(v1_x,v1_y, v2_x,v2_y, c_x,c_y, 0) + bias_w1)>>p;
+    rint_big w2_row = (functions::orient2d<int, rint_big>(v2_x,v2_y, v0_x,v0_y, c_x,c_y, 0) + bias_w2)>>p;
+    const rint_big A01 = (v0_y - v1_y), A12 = (v1_y - v2_y), A20 = (v2_y - v0_y);
+    const rint_big B01 = (v1_x - v0_x), B12 = (v2_x - v1_x), B20 = (v0_x - v2_x);
+    const int width = bbox.width();
+    for (int y = bbox.top; y < bbox.bottom; ++y, w0_row+=B01, w1_row+=B12, w2_row+=B20) {
+        int from=0, to=width-1;
+        clipSpanToEdge(w0_row, A01, 0, from, to);
+        clipSpanToEdge(w1_row, A12, 0, from, to);
+        clipSpanToEdge(w2_row, A20, 0, from, to);
+        auto * row = &stencil(bbox.left-stencil_rect.left, y-stencil_rect.top);
+        for (int x = from; x <= to; ++x) row[x] += step;
+    }
+}
+
 template<typename bitmap_type, microgl::ints::uint8_t options>
 template<typename number>
 void canvas<bitmap_type, options>::drawWuLine(const color_t &color,
@@ -1495,6 +2469,10 @@ void canvas<bitmap_type, options>::drawWuLine(const color_t &color,
     int y0_ = microgl::math::to_fixed(clip.y0, p);
     int x1_ = microgl::math::to_fixed(clip.x1, p);
     int y1_ = microgl::math::to_fixed(clip.y1, p);
+    // anti-aliased pixels are paired with a neighbour pixel to the side or below of the path
+    _damage.add(rect{(functions::min(x0_, x1_)>>p)-1, functions::min(y0_, y1_)>>p,
+                     (functions::max(x0_, x1_)>>p)+2, (functions::max(y0_, y1_)>>p)+2}.intersect(
+                     {draw_rect.left, draw_rect.top, draw_rect.right+1, draw_rect.bottom+1}));
     drawWuLine_internal(color, x0_, y0_, x1_, y1_, p, opacity);
 }
 
@@ -1675,64 +2653,114 @@ template<bool tint, bool smooth, bool frame, typename bitmap_font_type>
 void canvas<bitmap_type, options>::drawText(const char * text, microgl::text::bitmap_font<bitmap_font_type> &font,
                                        const color_t & color, microgl::text::text_format & format,
                                        int left, int top, int right, int bottom, opacity_t opacity) {
-    rect old=clipRect(); updateClipRect(left, top, right, bottom);
     unsigned int text_size=0;
     { const char * iter=text; while(*iter++!= '\0' && ++text_size); }
-    microgl::text::char_location loc_buffer[256];
-    const auto result=font.layout_text(text, text_size, right-left, bottom-top, format, loc_buffer);
-    unsigned count= result.end_index;
+    drawText_internal<tint, smooth, frame>(font, color,
+            [&](microgl::text::char_location * locations, int capacity, const microgl::text::text_layout_result * previous) {
+        return font.layout_text(text, text_size, right-left, bottom-top, format, locations, capacity, previous);
+    }, left, top, right, bottom, opacity);
+}
+
+template<typename bitmap_type, microgl::ints::uint8_t options>
+template<bool tint, bool smooth, bool frame, typename bitmap_font_type, unsigned entries, class Allocator>
+void canvas<bitmap_type, options>::drawText(const char * text, microgl::text::bitmap_font<bitmap_font_type> &font,
+                                       const color_t & color, microgl::text::text_format & format,
+                                       microgl::text::layout_cache<entries, Allocator> & layouts,
+                                       int left, int top, int right, int bottom, opacity_t opacity) {
+    unsigned int text_size=0;
+    { const char * iter=text; while(*iter++!= '\0' && ++text_size); }
+    drawText_internal<tint, smooth, frame>(font, color,
+            [&](microgl::text::char_location * locations, int capacity, const microgl::text::text_layout_result * previous) {
+        return layouts.layout(font, text, text_size, right-left, bottom-top, format, locations, capacity, previous);
+    }, left, top, right, bottom, opacity);
+}
+
+template<typename bitmap_type, microgl::ints::uint8_t options>
+template<bool tint, bool smooth, bool frame, typename bitmap_font_type, typename layout_function>
+void canvas<bitmap_type, options>::drawText_internal(microgl::text::bitmap_font<bitmap_font_type> &font,
+                                                const color_t & color, const layout_function & layout,
+                                                int left, int top, int right, int bottom, opacity_t opacity) {
+    rect old=clipRect(); updateClipRect(left, top, right, bottom);
+    // long texts are laid out and drawn in chunks of the buffer
+    constexpr int buffer_size=256;
+    microgl::text::char_location loc_buffer[buffer_size];
+    auto result=layout(loc_buffer, buffer_size, nullptr);
     const int s=result.scale, PP=result.precision;
     const bool has_scaled=s!=1<<PP;
-    if(has_scaled){ // we use the sampler for scaled
-        constexpr auto filter = smooth ? sampling::texture_filter::Bilinear : sampling::texture_filter::NearestNeighboor;
-        using tex = microgl::sampling::texture<bitmap_font_type, filter, tint>;
-        tex texture{font.bitmap, color};
-        const int UVP=renderingOptions()._2d_raster_bits_uv;
-        int u0, v0, u1, v1;
-        for (unsigned ix = 0; ix < count; ++ix) {
-            const auto & l= result.locations[ix];
-            // i invert vertical axis because bitmap fonts atlas space is top to bottom,
-            // but uv space is inverted
-            u0=(l.character->x<<UVP)/font.bitmap->width();
-            u1=((l.character->x+l.character->width)<<UVP)/font.bitmap->width();
-            v0= ((font.bitmap->height() - l.character->y) << UVP) / font.bitmap->height();
-            v1= ((font.bitmap->height() - l.character->y - l.character->height) << UVP) / font.bitmap->height();
-            v0=((l.character->y)<<UVP)/font.bitmap->height();
-            v1=((l.character->y+l.character->height)<<UVP)/font.bitmap->height();
-            int ll= l.x; ll+=left<<PP; int tt= l.y; tt+=top<<PP;
-            int rr= ll + ((l.character->width*s)); int bb= tt + ((l.character->height*s));
-            drawRect_internal<blendmode::Normal, porterduff::FastSourceOverOnOpaque, false, decltype(texture)>(
-                    texture, ll, tt, rr, bb, u0, v0, u1, v1, PP, UVP, opacity
-            );
+    while (true) {
+        unsigned count= result.end_index;
+        if(font.sdf_spread>0) { // distance fields are sampled at any scale
+            using sdf = microgl::sampling::sdf_texture<bitmap_font_type>;
+            sdf texture{font.bitmap, color, sdf::half_width(font.sdf_spread, s, PP)};
+            const int UVP=renderingOptions()._2d_raster_bits_uv;
+            const int w=font.bitmap->width(), h=font.bitmap->height();
+            for (unsigned ix = 0; ix < count; ++ix) {
+                const auto & c= *result.locations[ix].character;
+                if(c.width<=0 || c.height<=0) continue;
+                // a pixel of margin for the edges, that smooth outside of the glyph
+                const int ll= result.locations[ix].x + (left<<PP) - s, tt= result.locations[ix].y + (top<<PP) - s;
+                const int rr= ll + (c.width+2)*s, bb= tt + (c.height+2)*s;
+                drawRect_internal<blendmode::Normal, porterduff::FastSourceOverOnOpaque, false, sdf>(texture, ll, tt, rr, bb,
+                        ((c.x-1)<<UVP)/w, ((c.y-1)<<UVP)/h, ((c.x+c.width+1)<<UVP)/w, ((c.y+c.height+1)<<UVP)/h,
+                        PP, UVP, opacity);
+            }
         }
-    }
-    else { // the sampler above gives amazing results for unscaled graphics, but I  to go for the most accurate version
-        constexpr microgl::ints::uint8_t r_ = bitmap_font_type::rgba::r;
-        constexpr microgl::ints::uint8_t g_ = bitmap_font_type::rgba::g;
-        constexpr microgl::ints::uint8_t b_ = bitmap_font_type::rgba::b;
-        constexpr microgl::ints::uint8_t a_ = bitmap_font_type::rgba::a;
-        for (unsigned ix = 0; ix < count; ++ix) {
-            const auto & l= result.locations[ix];
-            const auto & c= *l.character;
-            int ll= l.x>>PP; ll+= left; int tt= l.y>>PP; tt+=top;
-            int rr= ll+c.width; int bb= tt+c.height;
-            rect box{ll, tt, rr, bb};
-            rect draw_rect=calculateEffectiveDrawRect();
-            auto b_r=box.intersect(draw_rect);
-            color_t font_col;
-            for (int y = b_r.top; y < b_r.bottom; ++y) {
-                for (int x = b_r.left; x < b_r.right; ++x) {
-                    font.bitmap->decode(c.x + x - b_r.left, (c.y + y - b_r.top), font_col);
-                    if(tint) {
-                        font_col.r = microgl::mc<r_>(font_col.r, color.r);
-                        font_col.g = microgl::mc<g_>(font_col.g, color.g);
-                        font_col.b = microgl::mc<b_>(font_col.b, color.b);
-                        font_col.a = microgl::mc<a_>(font_col.a, color.a);
+        else if(has_scaled){ // we use the sampler for scaled
+            constexpr auto filter = smooth ? sampling::texture_filter::Bilinear : sampling::texture_filter::NearestNeighboor;
+            using tex = microgl::sampling::texture<bitmap_font_type, filter, tint>;
+            tex texture{font.bitmap, color};
+            const int UVP=renderingOptions()._2d_raster_bits_uv;
+            int u0, v0, u1, v1;
+            for (unsigned ix = 0; ix < count; ++ix) {
+                const auto & l= result.locations[ix];
+                // i invert vertical axis because bitmap fonts atlas space is top to bottom,
+                // but uv space is inverted
+                u0=(l.character->x<<UVP)/font.bitmap->width();
+                u1=((l.character->x+l.character->width)<<UVP)/font.bitmap->width();
+                v0= ((font.bitmap->height() - l.character->y) << UVP) / font.bitmap->height();
+                v1= ((font.bitmap->height() - l.character->y - l.character->height) << UVP) / font.bitmap->height();
+                v0=((l.character->y)<<UVP)/font.bitmap->height();
+                v1=((l.character->y+l.character->height)<<UVP)/font.bitmap->height();
+                int ll= l.x; ll+=left<<PP; int tt= l.y; tt+=top<<PP;
+                int rr= ll + ((l.character->width*s)); int bb= tt + ((l.character->height*s));
+                drawRect_internal<blendmode::Normal, porterduff::FastSourceOverOnOpaque, false, decltype(texture)>(
+                        texture, ll, tt, rr, bb, u0, v0, u1, v1, PP, UVP, opacity
+                );
+            }
+        }
+        else { // the sampler above gives amazing results for unscaled graphics, but I  to go for the most accurate version
+            constexpr microgl::ints::uint8_t r_ = bitmap_font_type::rgba::r;
+            constexpr microgl::ints::uint8_t g_ = bitmap_font_type::rgba::g;
+            constexpr microgl::ints::uint8_t b_ = bitmap_font_type::rgba::b;
+            constexpr microgl::ints::uint8_t a_ = bitmap_font_type::rgba::a;
+            for (unsigned ix = 0; ix < count; ++ix) {
+                const auto & l= result.locations[ix];
+                const auto & c= *l.character;
+                int ll= l.x>>PP; ll+= left; int tt= l.y>>PP; tt+=top;
+                int rr= ll+c.width; int bb= tt+c.height;
+                rect box{ll, tt, rr, bb};
+                // the effective rect is inclusive, glyphs clipped on the left or top keep their offset
+                rect draw_rect=calculateEffectiveDrawRect();
+                draw_rect.right+=1; draw_rect.bottom+=1;
+                auto b_r=box.intersect(draw_rect);
+                _damage.add(b_r);
+                color_t font_col;
+                for (int y = b_r.top; y < b_r.bottom; ++y) {
+                    for (int x = b_r.left; x < b_r.right; ++x) {
+                        font.bitmap->decode(c.x + x - ll, (c.y + y - tt), font_col);
+                        if(tint) {
+                            font_col.r = microgl::mc<r_>(font_col.r, color.r);
+                            font_col.g = microgl::mc<g_>(font_col.g, color.g);
+                            font_col.b = microgl::mc<b_>(font_col.b, color.b);
+                            font_col.a = microgl::mc<a_>(font_col.a, color.a);
+                        }
+                        blendColor<blendmode::Normal, porterduff::FastSourceOverOnOpaque, a_>(font_col, x, y, opacity);
                     }
-                    blendColor<blendmode::Normal, porterduff::FastSourceOverOnOpaque, a_>(font_col, x, y, opacity);
                 }
             }
         }
+        if(result.next_index<0) break;
+        result=layout(loc_buffer, buffer_size, &result);
     }
     if(frame) {
         drawWuLine(color, left, top, left, bottom);
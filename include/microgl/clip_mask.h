@@ -0,0 +1,136 @@
+/*========================================================================================
+ Copyright (2021), Tomer Shalev (tomer.shalev@gmail.com, https://github.com/HendrixString).
+ All Rights Reserved.
+ License is a custom open source semi-permissive license with the following guidelines:
+ 1. unless otherwise stated, derivative work and usage of this file is permitted and
+    should be credited to the project and the author of this project.
+ 2. Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+========================================================================================*/
+#pragma once
+
+#include "./stdint.h"
+#include "rect.h"
+#include "traits.h"
+
+namespace microgl {
+    /**
+     * an 8 bit coverage mask over a rectangle of the canvas, pixels outside of it have no
+     * coverage. the rows of the memory may be wider than the rectangle, a canvas stores them
+     * with its own stride, so the index of a pixel in the canvas is also its offset in the
+     * mask. the memory is kept between resets, so a mask, that is rasterized every frame,
+     * allocates only when it grows
+     *
+     * @tparam Allocator the allocator of the coverage
+     */
+    template<class Allocator=microgl::traits::std_rebind_allocator<>>
+    class clip_mask {
+    public:
+        using value_type = microgl::ints::uint8_t;
+        using allocator_type = typename Allocator::template rebind<value_type>::other;
+        using rect = microgl::rect_t<int>;
+    private:
+        allocator_type _allocator;
+        value_type *_data = nullptr;
+        rect _bounds;
+        // the memory holds the rows of the bounds from x=_left, (_stride) pixels each
+        int _left = 0, _stride = 0, _size = 0;
+        int _capacity = 0;
+
+        void release() {
+            _data = nullptr; _bounds = {};
+            _left = _stride = _size = _capacity = 0;
+        }
+    public:
+        explicit clip_mask(const Allocator &allocator = Allocator()) : _allocator(allocator) {}
+        clip_mask(const clip_mask &) = delete;
+        clip_mask & operator=(const clip_mask &) = delete;
+        clip_mask(clip_mask && mask) noexcept : _allocator(mask._allocator), _data(mask._data),
+                _bounds(mask._bounds), _left(mask._left), _stride(mask._stride), _size(mask._size),
+                _capacity(mask._capacity) {
+            mask.release();
+        }
+        clip_mask & operator=(clip_mask && mask) noexcept {
+            if(&mask==this) return *this;
+            if(_data) _allocator.deallocate(_data, _capacity);
+            _allocator = mask._allocator; _data = mask._data; _bounds = mask._bounds;
+            _left = mask._left; _stride = mask._stride; _size = mask._size; _capacity = mask._capacity;
+            mask.release();
+            return *this;
+        }
+        ~clip_mask() { if(_data) _allocator.deallocate(_data, _capacity); }
+
+        void updateAllocator(const Allocator &allocator) {
+            if(_data) _allocator.deallocate(_data, _capacity);
+            release();
+            _allocator = allocator_type(allocator);
+        }
+
+        /**
+         * cover a new rectangle with zero coverage, right/bottom exclusive
+         */
+        void reset(const rect & bounds) { reset(bounds, bounds.left, bounds.width()); }
+
+        /**
+         * cover a new rectangle with zero coverage, right/bottom exclusive, with rows of
+         * (stride) pixels from x=left, that contain the rectangle
+         */
+        void reset(const rect & bounds, int left, int stride) {
+            const bool empty = bounds.empty() || bounds.left<left || bounds.right>left+stride;
+            _bounds = empty ? rect{} : bounds;
+            _left = empty ? 0 : left; _stride = empty ? 0 : stride;
+            _size = _stride*_bounds.height();
+            if(_size>_capacity) {
+                if(_data) _allocator.deallocate(_data, _capacity);
+                _data = _allocator.allocate(_size);
+                _capacity = _size;
+            }
+            for (int ix = 0; ix < _size; ++ix) _data[ix] = 0;
+        }
+
+        /**
+         * copy the coverage of another mask, with the allocator of this mask
+         */
+        void assign(const clip_mask & mask) {
+            reset(mask._bounds, mask._left, mask._stride);
+            for (int ix = 0; ix < _size; ++ix) _data[ix] = mask._data[ix];
+        }
+
+        const rect & bounds() const { return _bounds; }
+        int width() const { return _bounds.width(); }
+        int height() const { return _bounds.height(); }
+        // the x of the first pixel of the rows of the memory
+        int left() const { return _left; }
+        // the pixels of a row of the memory
+        int stride() const { return _stride; }
+        int size() const { return _size; }
+        value_type *data() { return _data; }
+        const value_type *data() const { return _data; }
+        // the coverage of the row y, starting at x=left()
+        const value_type *row(int y) const { return _data + (y-_bounds.top)*_stride; }
+
+        value_type coverage(int x, int y) const {
+            if(x<_bounds.left || y<_bounds.top || x>=_bounds.right || y>=_bounds.bottom) return 0;
+            return _data[(y-_bounds.top)*_stride + x-_left];
+        }
+
+        /**
+         * the coverage at an offset of the memory, zero outside of it
+         */
+        value_type at(int offset) const {
+            return unsigned(offset)<unsigned(_size) ? _data[offset] : 0;
+        }
+
+        /**
+         * multiply the coverage by the coverage of another mask
+         */
+        void intersect(const clip_mask & mask) {
+            for (int y = _bounds.top; y < _bounds.bottom; ++y) {
+                value_type * cov = _data + (y-_bounds.top)*_stride - _left;
+                for (int x = _bounds.left; x < _bounds.right; ++x)
+                    cov[x] = value_type((int(cov[x])*mask.coverage(x, y)*257 + 257)>>16);
+            }
+        }
+    };
+}
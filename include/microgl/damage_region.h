@@ -0,0 +1,101 @@
+/*========================================================================================
+ Copyright (2021), Tomer Shalev (tomer.shalev@gmail.com, https://github.com/HendrixString).
+ All Rights Reserved.
+ License is a custom open source semi-permissive license with the following guidelines:
+ 1. unless otherwise stated, derivative work and usage of this file is permitted and
+    should be credited to the project and the author of this project.
+ 2. Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+========================================================================================*/
+#pragma once
+
+#include "rect.h"
+#include "stdint.h"
+
+namespace microgl {
+
+    /**
+     * a region of at most (max_rects) rectangles, that accumulates the areas a canvas drew into.
+     * a rectangle is merged with a rectangle of the region, if their union is not bigger than
+     * both of them together (they overlap or share an edge). when the region is full, a new
+     * rectangle is merged with the rectangle, that grows the least. rectangles are
+     * right/bottom exclusive.
+     *
+     * @tparam max_rects max number of rectangles
+     */
+    template<unsigned max_rects=8>
+    class damage_region {
+        static_assert(max_rects>0, "a damage region needs at least one rectangle");
+    public:
+        using rect = microgl::rect_t<int>;
+
+    private:
+        using area_t = microgl::ints::int64_t;
+        rect _rects[max_rects];
+        unsigned _size = 0;
+
+        static rect unite(const rect & a, const rect & b) {
+            return {a.left<b.left ? a.left : b.left, a.top<b.top ? a.top : b.top,
+                    a.right>b.right ? a.right : b.right, a.bottom>b.bottom ? a.bottom : b.bottom};
+        }
+        static area_t area(const rect & r) { return area_t(r.width())*r.height(); }
+        void remove(unsigned ix) { _rects[ix]=_rects[--_size]; }
+
+    public:
+        damage_region() = default;
+
+        /**
+         * add a rectangle to the region
+         * @param r right/bottom exclusive rectangle
+         */
+        void add(const rect & r) {
+            if(r.empty()) return;
+            for (unsigned ix = 0; ix < _size; ++ix) // already damaged
+                if(rect(r)<=_rects[ix]) return;
+            rect u = r;
+            while (true) {
+                bool merged = false;
+                for (unsigned ix = 0; ix < _size; ++ix) {
+                    if(area(unite(u, _rects[ix])) > area(u) + area(_rects[ix])) continue;
+                    u = unite(u, _rects[ix]); remove(ix);
+                    merged = true; break;
+                }
+                if(merged) continue; // a bigger union may merge with others
+                if(_size < max_rects) { _rects[_size++] = u; return; }
+                // region is full, merge with the rectangle, that grows the least
+                unsigned best = 0; area_t best_growth = 0;
+                for (unsigned ix = 0; ix < _size; ++ix) {
+                    const area_t growth = area(unite(u, _rects[ix])) - area(_rects[ix]);
+                    if(ix==0 || growth < best_growth) { best = ix; best_growth = growth; }
+                }
+                u = unite(u, _rects[best]); remove(best);
+            }
+        }
+        void add(int left, int top, int right, int bottom) { add(rect{left, top, right, bottom}); }
+
+        // does a rectangle intersect the region
+        bool intersects(const rect & r) const {
+            for (unsigned ix = 0; ix < _size; ++ix)
+                if(_rects[ix].intersects(r)) return true;
+            return false;
+        }
+
+        // bounding rectangle of the region, empty if the region is empty
+        rect bounds() const {
+            if(_size==0) return {};
+            rect b = _rects[0];
+            for (unsigned ix = 1; ix < _size; ++ix) b = unite(b, _rects[ix]);
+            return b;
+        }
+
+        void clear() { _size = 0; }
+        bool empty() const { return _size==0; }
+        unsigned size() const { return _size; }
+        static constexpr unsigned capacity() { return max_rects; }
+        const rect & operator[](unsigned index) const { return _rects[index]; }
+        const rect * begin() const { return _rects; }
+        const rect * end() const { return _rects + _size; }
+    };
+
+}
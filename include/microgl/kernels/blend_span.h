@@ -0,0 +1,442 @@
+/*========================================================================================
+ Copyright (2021), Tomer Shalev (tomer.shalev@gmail.com, https://github.com/HendrixString).
+ All Rights Reserved.
+ License is a custom open source semi-permissive license with the following guidelines:
+ 1. unless otherwise stated, derivative work and usage of this file is permitted and
+    should be credited to the project and the author of this project.
+ 2. Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+========================================================================================*/
+#pragma once
+
+#include "../color.h"
+#include "../stdint.h"
+#include "../bitmaps/bitmap_view.h"
+#include "../pixel_coders/RGBA_PACKED.h"
+#include "../blend_modes/Normal.h"
+#include "../porter_duff/FastSourceOverOnOpaque.h"
+#include "../porter_duff/SourceOver.h"
+#include "../porter_duff/None.h"
+
+// vector kernels are selected by the instruction sets, that the compiler targets,
+// define MICROGL_NO_SIMD to always blend with the scalar canvas path
+#if !defined(MICROGL_NO_SIMD)
+#if defined(__AVX2__)
+#define MICROGL_SIMD_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP>=2)
+#define MICROGL_SIMD_SSE2
+#include <emmintrin.h>
+#elif (defined(__ARM_NEON) || defined(__ARM_NEON__)) && !defined(__BIG_ENDIAN__) && \
+      !(defined(__BYTE_ORDER__) && __BYTE_ORDER__==__ORDER_BIG_ENDIAN__)
+#define MICROGL_SIMD_NEON
+#include <arm_neon.h>
+#endif
+#endif
+
+namespace microgl {
+    namespace kernels {
+        using u8 = microgl::ints::uint8_t;
+        using u16 = microgl::ints::uint16_t;
+        using u32 = microgl::ints::uint32_t;
+
+        /**
+         * pixel layouts, that have row kernels. only regular bitmaps and views qualify, packed and
+         * palette bitmaps do not store a pixel per array element.
+         *
+         * 32 bit layouts keep every channel in a byte, shifts are the bit offsets of the
+         * channels, a layout without alpha keeps zero at the alpha byte.
+         */
+        template<class bitmap_type>
+        struct span_layout {
+            static constexpr bool supported = false;
+        };
+
+        template<class allocator_type>
+        struct span_layout<bitmap<coder::RGBA_PACKED<8,8,8,0>, allocator_type>> {
+            static constexpr bool supported = true, packed_32 = true, alpha = false;
+            static constexpr int r = 16, g = 8, b = 0, a = 24;
+        };
+
+        template<class allocator_type>
+        struct span_layout<bitmap<coder::RGBA_PACKED<8,8,8,8>, allocator_type>> {
+            static constexpr bool supported = true, packed_32 = true, alpha = true;
+            static constexpr int r = 24, g = 16, b = 8, a = 0;
+        };
+
+        template<class allocator_type>
+        struct span_layout<bitmap<coder::RGBA_PACKED<5,6,5,0>, allocator_type>> {
+            static constexpr bool supported = true, packed_32 = false, alpha = false;
+            static constexpr int r = 11, g = 5, b = 0, a = 0;
+        };
+
+        // views have the rows of regular bitmaps
+        template<class pixel_coder, class allocator_type>
+        struct span_layout<bitmap_view<pixel_coder, allocator_type>> :
+                public span_layout<bitmap<pixel_coder, allocator_type>> {};
+
+        /**
+         * blend and composite pairs, that have row kernels. Normal blending skips the
+         * blend mode, so these are the cases where blending a pixel is pure arithmetic
+         */
+        enum class span_operator { unsupported, fast_source_over, source_over, none };
+
+        template<class BlendMode, class PorterDuff, bool backdrop_alpha>
+        struct span_operator_of {
+            static constexpr span_operator value = span_operator::unsupported;
+        };
+
+        template<bool backdrop_alpha>
+        struct span_operator_of<blendmode::Normal, porterduff::FastSourceOverOnOpaque, backdrop_alpha> {
+            static constexpr span_operator value = span_operator::fast_source_over;
+        };
+
+        // on canvases with alpha, source over un-multiplies with a division per channel
+        template<bool use_FPU>
+        struct span_operator_of<blendmode::Normal, porterduff::SourceOver<true, use_FPU>, false> {
+            static constexpr span_operator value = span_operator::source_over;
+        };
+
+        template<bool backdrop_alpha>
+        struct span_operator_of<blendmode::Normal, porterduff::None<true>, backdrop_alpha> {
+            static constexpr span_operator value = span_operator::none;
+        };
+
+#if defined(MICROGL_SIMD_SSE2)
+        /**
+         * SSE2, 8 pixels per step in 16 bit lanes
+         */
+        struct isa_sse2 {
+            using vec = __m128i;
+            static constexpr unsigned lanes = 8;
+
+            static vec set1(u16 v) { return _mm_set1_epi16(short(v)); }
+            static vec add(vec a, vec b) { return _mm_add_epi16(a, b); }
+            static vec sub(vec a, vec b) { return _mm_sub_epi16(a, b); }
+            static vec mullo(vec a, vec b) { return _mm_mullo_epi16(a, b); }
+            static vec mulhi(vec a, vec b) { return _mm_mulhi_epu16(a, b); }
+            static vec shr8(vec a) { return _mm_srli_epi16(a, 8); }
+            static vec eq(vec a, vec b) { return _mm_cmpeq_epi16(a, b); }
+            static vec select(vec mask, vec a, vec b) {
+                return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+            }
+
+            static vec load_coverage(const u8 * coverage) {
+                return _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)coverage), _mm_setzero_si128());
+            }
+
+            // channel of 8 pixels of 32 bits, 4 pixels in every register
+            template<int shift>
+            static vec channel(vec lo, vec hi) {
+                const vec mask = _mm_set1_epi32(0xff);
+                return _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(lo, shift), mask),
+                                       _mm_and_si128(_mm_srli_epi32(hi, shift), mask));
+            }
+            template<int shift>
+            static void put_channel(vec c, vec & lo, vec & hi) {
+                const vec zero = _mm_setzero_si128();
+                lo = _mm_or_si128(lo, _mm_slli_epi32(_mm_unpacklo_epi16(c, zero), shift));
+                hi = _mm_or_si128(hi, _mm_slli_epi32(_mm_unpackhi_epi16(c, zero), shift));
+            }
+
+            static void load_src(const color_t * src, vec & r, vec & g, vec & b, vec & a) {
+                const vec lo = _mm_loadu_si128((const __m128i *)src);
+                const vec hi = _mm_loadu_si128((const __m128i *)(src + 4));
+                r = channel<0>(lo, hi); g = channel<8>(lo, hi);
+                b = channel<16>(lo, hi); a = channel<24>(lo, hi);
+            }
+
+            template<class layout>
+            static void load_32(const u32 * dst, vec & r, vec & g, vec & b, vec & a) {
+                const vec lo = _mm_loadu_si128((const __m128i *)dst);
+                const vec hi = _mm_loadu_si128((const __m128i *)(dst + 4));
+                r = channel<layout::r>(lo, hi); g = channel<layout::g>(lo, hi);
+                b = channel<layout::b>(lo, hi); a = channel<layout::a>(lo, hi);
+            }
+            template<class layout>
+            static void store_32(u32 * dst, vec r, vec g, vec b, vec a) {
+                vec lo = _mm_setzero_si128(), hi = _mm_setzero_si128();
+                put_channel<layout::r>(r, lo, hi); put_channel<layout::g>(g, lo, hi);
+                put_channel<layout::b>(b, lo, hi); put_channel<layout::a>(a, lo, hi);
+                _mm_storeu_si128((__m128i *)dst, lo);
+                _mm_storeu_si128((__m128i *)(dst + 4), hi);
+            }
+
+            static void load_565(const u16 * dst, vec & r, vec & g, vec & b) {
+                const vec p = _mm_loadu_si128((const __m128i *)dst);
+                r = _mm_srli_epi16(p, 11);
+                g = _mm_and_si128(_mm_srli_epi16(p, 5), set1(63));
+                b = _mm_and_si128(p, set1(31));
+            }
+            static void store_565(u16 * dst, vec r, vec g, vec b) {
+                const vec p = _mm_or_si128(_mm_or_si128(_mm_slli_epi16(_mm_and_si128(r, set1(31)), 11),
+                                                        _mm_slli_epi16(_mm_and_si128(g, set1(63)), 5)),
+                                           _mm_and_si128(b, set1(31)));
+                _mm_storeu_si128((__m128i *)dst, p);
+            }
+        };
+        using isa = isa_sse2;
+#elif defined(MICROGL_SIMD_AVX2)
+        /**
+         * AVX2, 16 pixels per step in 16 bit lanes. packing works inside 128 bit halves,
+         * lanes are permuted back to pixel order after packing and before unpacking
+         */
+        struct isa_avx2 {
+            using vec = __m256i;
+            static constexpr unsigned lanes = 16;
+
+            static vec set1(u16 v) { return _mm256_set1_epi16(short(v)); }
+            static vec add(vec a, vec b) { return _mm256_add_epi16(a, b); }
+            static vec sub(vec a, vec b) { return _mm256_sub_epi16(a, b); }
+            static vec mullo(vec a, vec b) { return _mm256_mullo_epi16(a, b); }
+            static vec mulhi(vec a, vec b) { return _mm256_mulhi_epu16(a, b); }
+            static vec shr8(vec a) { return _mm256_srli_epi16(a, 8); }
+            static vec eq(vec a, vec b) { return _mm256_cmpeq_epi16(a, b); }
+            static vec select(vec mask, vec a, vec b) { return _mm256_blendv_epi8(b, a, mask); }
+
+            static vec load_coverage(const u8 * coverage) {
+                return _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)coverage));
+            }
+
+            // channel of 16 pixels of 32 bits, 8 pixels in every register
+            template<int shift>
+            static vec channel(vec lo, vec hi) {
+                const vec mask = _mm256_set1_epi32(0xff);
+                const vec packed = _mm256_packs_epi32(_mm256_and_si256(_mm256_srli_epi32(lo, shift), mask),
+                                                      _mm256_and_si256(_mm256_srli_epi32(hi, shift), mask));
+                return _mm256_permute4x64_epi64(packed, 0xD8);
+            }
+            template<int shift>
+            static void put_channel(vec c, vec & lo, vec & hi) {
+                lo = _mm256_or_si256(lo, _mm256_slli_epi32(_mm256_cvtepu16_epi32(_mm256_castsi256_si128(c)), shift));
+                hi = _mm256_or_si256(hi, _mm256_slli_epi32(_mm256_cvtepu16_epi32(_mm256_extracti128_si256(c, 1)), shift));
+            }
+
+            static void load_src(const color_t * src, vec & r, vec & g, vec & b, vec & a) {
+                const vec lo = _mm256_loadu_si256((const __m256i *)src);
+                const vec hi = _mm256_loadu_si256((const __m256i *)(src + 8));
+                r = channel<0>(lo, hi); g = channel<8>(lo, hi);
+                b = channel<16>(lo, hi); a = channel<24>(lo, hi);
+            }
+
+            template<class layout>
+            static void load_32(const u32 * dst, vec & r, vec & g, vec & b, vec & a) {
+                const vec lo = _mm256_loadu_si256((const __m256i *)dst);
+                const vec hi = _mm256_loadu_si256((const __m256i *)(dst + 8));
+                r = channel<layout::r>(lo, hi); g = channel<layout::g>(lo, hi);
+                b = channel<layout::b>(lo, hi); a = channel<layout::a>(lo, hi);
+            }
+            template<class layout>
+            static void store_32(u32 * dst, vec r, vec g, vec b, vec a) {
+                vec lo = _mm256_setzero_si256(), hi = _mm256_setzero_si256();
+                put_channel<layout::r>(r, lo, hi); put_channel<layout::g>(g, lo, hi);
+                put_channel<layout::b>(b, lo, hi); put_channel<layout::a>(a, lo, hi);
+                _mm256_storeu_si256((__m256i *)dst, lo);
+                _mm256_storeu_si256((__m256i *)(dst + 8), hi);
+            }
+
+            static void load_565(const u16 * dst, vec & r, vec & g, vec & b) {
+                const vec p = _mm256_loadu_si256((const __m256i *)dst);
+                r = _mm256_srli_epi16(p, 11);
+                g = _mm256_and_si256(_mm256_srli_epi16(p, 5), set1(63));
+                b = _mm256_and_si256(p, set1(31));
+            }
+            static void store_565(u16 * dst, vec r, vec g, vec b) {
+                const vec p = _mm256_or_si256(_mm256_or_si256(_mm256_slli_epi16(_mm256_and_si256(r, set1(31)), 11),
+                                                              _mm256_slli_epi16(_mm256_and_si256(g, set1(63)), 5)),
+                                              _mm256_and_si256(b, set1(31)));
+                _mm256_storeu_si256((__m256i *)dst, p);
+            }
+        };
+        using isa = isa_avx2;
+#elif defined(MICROGL_SIMD_NEON)
+        /**
+         * NEON, 8 pixels per step in 16 bit lanes, 32 bit pixels are de-interleaved by
+         * bytes, which assumes a little endian memory order
+         */
+        struct isa_neon {
+            using vec = uint16x8_t;
+            static constexpr unsigned lanes = 8;
+
+            static vec set1(u16 v) { return vdupq_n_u16(v); }
+            static vec add(vec a, vec b) { return vaddq_u16(a, b); }
+            static vec sub(vec a, vec b) { return vsubq_u16(a, b); }
+            static vec mullo(vec a, vec b) { return vmulq_u16(a, b); }
+            static vec mulhi(vec a, vec b) {
+                return vcombine_u16(vshrn_n_u32(vmull_u16(vget_low_u16(a), vget_low_u16(b)), 16),
+                                    vshrn_n_u32(vmull_u16(vget_high_u16(a), vget_high_u16(b)), 16));
+            }
+            static vec shr8(vec a) { return vshrq_n_u16(a, 8); }
+            static vec eq(vec a, vec b) { return vceqq_u16(a, b); }
+            static vec select(vec mask, vec a, vec b) { return vbslq_u16(mask, a, b); }
+
+            static vec load_coverage(const u8 * coverage) { return vmovl_u8(vld1_u8(coverage)); }
+
+            static void load_src(const color_t * src, vec & r, vec & g, vec & b, vec & a) {
+                const uint8x8x4_t c = vld4_u8((const u8 *)src);
+                r = vmovl_u8(c.val[0]); g = vmovl_u8(c.val[1]);
+                b = vmovl_u8(c.val[2]); a = vmovl_u8(c.val[3]);
+            }
+
+            template<class layout>
+            static void load_32(const u32 * dst, vec & r, vec & g, vec & b, vec & a) {
+                const uint8x8x4_t c = vld4_u8((const u8 *)dst);
+                r = vmovl_u8(c.val[layout::r/8]); g = vmovl_u8(c.val[layout::g/8]);
+                b = vmovl_u8(c.val[layout::b/8]); a = vmovl_u8(c.val[layout::a/8]);
+            }
+            template<class layout>
+            static void store_32(u32 * dst, vec r, vec g, vec b, vec a) {
+                uint8x8x4_t c;
+                c.val[layout::r/8] = vmovn_u16(r); c.val[layout::g/8] = vmovn_u16(g);
+                c.val[layout::b/8] = vmovn_u16(b); c.val[layout::a/8] = vmovn_u16(a);
+                vst4_u8((u8 *)dst, c);
+            }
+
+            static void load_565(const u16 * dst, vec & r, vec & g, vec & b) {
+                const vec p = vld1q_u16(dst);
+                r = vshrq_n_u16(p, 11);
+                g = vandq_u16(vshrq_n_u16(p, 5), set1(63));
+                b = vandq_u16(p, set1(31));
+            }
+            static void store_565(u16 * dst, vec r, vec g, vec b) {
+                const vec p = vorrq_u16(vorrq_u16(vshlq_n_u16(vandq_u16(r, set1(31)), 11),
+                                                  vshlq_n_u16(vandq_u16(g, set1(63)), 5)),
+                                        vandq_u16(b, set1(31)));
+                vst1q_u16(dst, p);
+            }
+        };
+        using isa = isa_neon;
+#endif
+
+#if defined(MICROGL_SIMD_SSE2) || defined(MICROGL_SIMD_AVX2) || defined(MICROGL_SIMD_NEON)
+#define MICROGL_SIMD
+#endif
+
+        /**
+         * row kernel, that blends and composites a span of source colors into a row of
+         * pixels. the kernel reproduces the integer math of canvas::blendColor exactly:
+         *
+         * 1. the source alpha (8 bits, or opaque if the sampler has no alpha) is scaled by
+         *    the opacity with the blinn method (a*opacity*257 + 257) >> 16
+         * 2. fast source over:  c = (a*s + (255-a)*b) >> 8, transparent sources keep the pixel
+         *    source over:       c = (255*(a*s + (255-a)*b)) >> 16, canvases without alpha
+         *    none:              c = s, premultiplied by alpha on canvases without alpha,
+         *                       full opacity writes the source as is
+         *
+         * colors of 5 and 6 bits channels are blended with 8 bits alpha, like the scalar path.
+         * when there is no vector instruction set or the case is not supported, blend()
+         * blends nothing and the caller blends the span pixel by pixel.
+         *
+         * @tparam bitmap_type the bitmap type of the canvas
+         * @tparam BlendMode the blend mode
+         * @tparam PorterDuff the alpha compositing mode
+         * @tparam a_src alpha bits of the source colors
+         */
+        template<class bitmap_type, class BlendMode, class PorterDuff, u8 a_src>
+        struct blend_span {
+        private:
+            using layout = span_layout<bitmap_type>;
+            template<bool supported_layout, class dummy=void>
+            struct operator_of { static constexpr span_operator value = span_operator::unsupported; };
+            template<class dummy>
+            struct operator_of<true, dummy> {
+                static constexpr span_operator value = span_operator_of<BlendMode, PorterDuff, layout::alpha>::value;
+            };
+            static constexpr span_operator op = operator_of<layout::supported>::value;
+
+        public:
+#if defined(MICROGL_SIMD)
+            static constexpr bool supported = op!=span_operator::unsupported && (a_src==0 || a_src==8);
+#else
+            static constexpr bool supported = false;
+#endif
+
+            /**
+             * blend the longest prefix of the span, that is a multiple of the vector width
+             *
+             * @param dst first pixel of the row
+             * @param src source colors
+             * @param coverage per pixel opacity, or nullptr to use the opacity for all pixels
+             * @param opacity uniform opacity
+             * @param count number of pixels
+             *
+             * @return number of pixels, that were blended
+             */
+            template<typename pixel>
+            static unsigned blend(pixel * dst, const color_t * src, const u8 * coverage,
+                                  u8 opacity, unsigned count) {
+                return run<supported>(dst, src, coverage, opacity, count);
+            }
+
+        private:
+            template<bool enabled, typename pixel>
+            static typename microgl::traits::enable_if<!enabled, unsigned>::type
+            run(pixel *, const color_t *, const u8 *, u8, unsigned) { return 0; }
+
+#if defined(MICROGL_SIMD)
+            template<bool enabled, typename pixel>
+            static typename microgl::traits::enable_if<enabled, unsigned>::type
+            run(pixel * dst, const color_t * src, const u8 * coverage, u8 opacity, unsigned count) {
+                static_assert(sizeof(color_t)==4, "color_t is expected to be 4 bytes");
+                static_assert(sizeof(pixel)==(layout::packed_32 ? 4 : 2), "unexpected pixel size");
+                using vec = typename isa::vec;
+                constexpr bool src_alpha = a_src!=0;
+                const vec max = isa::set1(255), one = isa::set1(1), blinn = isa::set1(257);
+                const vec zero = isa::set1(0), uniform = isa::set1(opacity);
+                const vec written_alpha = layout::alpha ? max : zero;
+                unsigned ix = 0;
+                for (; ix + isa::lanes <= count; ix += isa::lanes) {
+                    vec sr, sg, sb, sa, br, bg, bb, ba=zero, r, g, b, a;
+                    isa::load_src(src + ix, sr, sg, sb, sa);
+                    const vec opacity_v = coverage ? isa::load_coverage(coverage + ix) : uniform;
+                    // blinn method, a*opacity <= 255*255, so (a*opacity + 1)*257 >> 16 fits in 16 bits
+                    // lanes. it is the identity for full opacity, so there is no need to branch
+                    const vec alpha = isa::mulhi(isa::add(isa::mullo(src_alpha ? sa : max, opacity_v), one), blinn);
+                    if(op==span_operator::none) {
+                        const vec as_is = isa::eq(opacity_v, max);
+                        if(layout::alpha) {
+                            r = sr; g = sg; b = sb; a = isa::select(as_is, sa, alpha);
+                        } else {
+                            r = isa::select(as_is, sr, isa::shr8(isa::mullo(sr, alpha)));
+                            g = isa::select(as_is, sg, isa::shr8(isa::mullo(sg, alpha)));
+                            b = isa::select(as_is, sb, isa::shr8(isa::mullo(sb, alpha)));
+                            a = written_alpha;
+                        }
+                    } else {
+                        load_dst(dst + ix, br, bg, bb, ba);
+                        const vec comp = isa::sub(max, alpha);
+                        r = isa::add(isa::mullo(alpha, sr), isa::mullo(comp, br));
+                        g = isa::add(isa::mullo(alpha, sg), isa::mullo(comp, bg));
+                        b = isa::add(isa::mullo(alpha, sb), isa::mullo(comp, bb));
+                        a = written_alpha;
+                        if(op==span_operator::fast_source_over) {
+                            r = isa::shr8(r); g = isa::shr8(g); b = isa::shr8(b);
+                            // transparent source pixels are skipped
+                            const vec skip = isa::eq(sa, zero);
+                            r = isa::select(skip, br, r); g = isa::select(skip, bg, g);
+                            b = isa::select(skip, bb, b); a = isa::select(skip, ba, a);
+                        } else {
+                            r = isa::mulhi(r, max); g = isa::mulhi(g, max); b = isa::mulhi(b, max);
+                        }
+                    }
+                    store_dst(dst + ix, r, g, b, a);
+                }
+                return ix;
+            }
+
+            template<typename pixel, typename vec>
+            static void load_dst(const pixel * dst, vec & r, vec & g, vec & b, vec & a) {
+                if(layout::packed_32) isa::template load_32<layout>((const u32 *)dst, r, g, b, a);
+                else isa::load_565((const u16 *)dst, r, g, b);
+            }
+            template<typename pixel, typename vec>
+            static void store_dst(pixel * dst, vec r, vec g, vec b, vec a) {
+                if(layout::packed_32) isa::template store_32<layout>((u32 *)dst, r, g, b, a);
+                else isa::store_565((u16 *)dst, r, g, b);
+            }
+#endif
+        };
+
+    }
+}
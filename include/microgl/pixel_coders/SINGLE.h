@@ -15,16 +15,16 @@
 namespace microgl {
     namespace coder {
 
-        template<uint8_t bits>
+        template<unsigned bits>
         using R = RGBA_PACKED<bits,0,0,0>;
 
-        template<uint8_t bits>
+        template<unsigned bits>
         using G = RGBA_PACKED<0,bits,0,0>;
 
-        template<uint8_t bits>
+        template<unsigned bits>
         using B = RGBA_PACKED<0,0,bits,0>;
 
-        template<uint8_t bits>
+        template<unsigned bits>
         using A = RGBA_PACKED<0,0,0,bits>;
     }
 }
\ No newline at end of file
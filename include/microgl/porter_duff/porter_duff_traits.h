@@ -0,0 +1,76 @@
+/*========================================================================================
+ Copyright (2021), Tomer Shalev (tomer.shalev@gmail.com, https://github.com/HendrixString).
+ All Rights Reserved.
+ License is a custom open source semi-permissive license with the following guidelines:
+ 1. unless otherwise stated, derivative work and usage of this file is permitted and
+    should be credited to the project and the author of this project.
+ 2. Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+========================================================================================*/
+#pragma once
+
+#include <microgl/porter_duff/None.h>
+#include <microgl/porter_duff/Clear.h>
+#include <microgl/porter_duff/Copy.h>
+#include <microgl/porter_duff/Source.h>
+#include <microgl/porter_duff/SourceOver.h>
+#include <microgl/porter_duff/FastSourceOverOnOpaque.h>
+
+namespace microgl {
+    namespace porterduff {
+
+        /**
+         * compile time info about how a compositing mode uses the backdrop.
+         *
+         * - ignores_backdrop: the result depends only on the source (Fb = 0 and Fa does not use
+         *   the backdrop alpha), so compositing a color gives the same pixel everywhere
+         * - opaque_source_ignores_backdrop: the result depends only on the source, when the
+         *   source alpha is max (Fb = 1 - αs)
+         *
+         * @tparam PorterDuff the alpha compositing mode
+         */
+        template<class PorterDuff>
+        struct porter_duff_traits {
+            static constexpr bool ignores_backdrop = false;
+            static constexpr bool opaque_source_ignores_backdrop = false;
+        };
+
+        template<bool fast>
+        struct porter_duff_traits<None<fast>> {
+            static constexpr bool ignores_backdrop = true;
+            static constexpr bool opaque_source_ignores_backdrop = true;
+        };
+
+        template<bool fast, bool use_FPU>
+        struct porter_duff_traits<Clear<fast, use_FPU>> {
+            static constexpr bool ignores_backdrop = true;
+            static constexpr bool opaque_source_ignores_backdrop = true;
+        };
+
+        template<bool fast, bool use_FPU>
+        struct porter_duff_traits<Copy<fast, use_FPU>> {
+            static constexpr bool ignores_backdrop = true;
+            static constexpr bool opaque_source_ignores_backdrop = true;
+        };
+
+        template<bool fast, bool use_FPU>
+        struct porter_duff_traits<Source<fast, use_FPU>> {
+            static constexpr bool ignores_backdrop = true;
+            static constexpr bool opaque_source_ignores_backdrop = true;
+        };
+
+        template<bool fast, bool use_FPU>
+        struct porter_duff_traits<SourceOver<fast, use_FPU>> {
+            static constexpr bool ignores_backdrop = false;
+            static constexpr bool opaque_source_ignores_backdrop = true;
+        };
+
+        template<>
+        struct porter_duff_traits<FastSourceOverOnOpaque> {
+            static constexpr bool ignores_backdrop = false;
+            static constexpr bool opaque_source_ignores_backdrop = true;
+        };
+
+    }
+}
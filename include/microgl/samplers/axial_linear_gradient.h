@@ -11,6 +11,7 @@
 #pragma once
 
 #include <microgl/color.h>
+#include <microgl/samplers/sampler.h>
 
 namespace microgl {
     namespace sampling {
@@ -61,7 +62,38 @@ namespace microgl {
 
             inline void sample(const int u, const int v,
                                const unsigned bits, color_t &output) const {
-                rint t, h= rint(1)<<(bits-1);
+                const auto u_tag= convert(axis(u, v, bits), bits, p_bits);
+                unsigned pos=0;
+                for (pos = 0; pos<index && u_tag>=_stops[pos].where; ++pos);
+                interpolate(pos, u_tag, output);
+            }
+
+            /**
+             * sample a span of pixels, see sampling::has_sample_span. the position on the axis
+             * is linear along the span, so it is stepped and the stops search continues from the
+             * stop of the previous pixel instead of starting over.
+             */
+            inline void sample_span(const int u, const int v, const int du, const int dv,
+                                    const unsigned bits, unsigned count, color_t *output) const {
+                constexpr unsigned F = span_fraction_bits;
+                // the axis is linear, so it is evaluated with the fraction bits and h is scaled
+                // to the extra precision, the shift below then gives the axis of the sampled coords
+                rint t= axis(u, v, bits+F);
+                const rint dt= axis(u+du, v+dv, bits+F) - t;
+                unsigned pos=0;
+                for (unsigned ix = 0; ix < count; ++ix, t+=dt) {
+                    const auto u_tag= convert(t, bits+F, p_bits);
+                    while(pos<index && u_tag>=_stops[pos].where) ++pos;
+                    while(pos>0 && u_tag<_stops[pos-1].where) --pos;
+                    interpolate(pos, u_tag, output[ix]);
+                }
+            }
+
+        private:
+
+            // position of a point on the axis of the gradient
+            static inline rint axis(const int u, const int v, const unsigned bits) {
+                rint t=0, h= rint(1)<<(bits-1);
                 if(degree<=0 || degree>315) t=u;
                 else if(degree<=45) t=(u+v-h);
                 else if(degree<=90) t=v;
@@ -70,9 +102,11 @@ namespace microgl {
                 else if(degree<=225) t=(rint(1)<<bits)-(u+v-h);
                 else if(degree<=270) t=(rint(1)<<bits)-v;
                 else if(degree<=315) t=u-v+h;
-                const auto u_tag= convert(t, bits, p_bits);
-                unsigned pos=0;
-                for (pos = 0; pos<index && u_tag>=_stops[pos].where; ++pos);
+                return t;
+            }
+
+            // color of a position on the axis, pos is the first stop after the position
+            inline void interpolate(const unsigned pos, const rint u_tag, color_t &output) const {
                 if(pos==index) {
                     output=_stops[index-1].color;
                     return;
@@ -92,8 +126,6 @@ namespace microgl {
                 output.a= rint(stop_0.color.a) + ((rint(stop_1.color.a-stop_0.color.a)*factor)>>p_bits);
             }
 
-        private:
-
             unsigned index= 0;
             stop_t _stops[N];
         };
@@ -34,5 +34,13 @@ namespace microgl {
             color_t color;
         };
 
+        /**
+         * compile time detection of flat color samplers
+         */
+        template<class Sampler>
+        struct is_flat_color { static constexpr bool value = false; };
+        template<typename rgba_>
+        struct is_flat_color<flat_color<rgba_>> { static constexpr bool value = true; };
+
     }
 }
\ No newline at end of file
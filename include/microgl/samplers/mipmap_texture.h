@@ -0,0 +1,156 @@
+/*========================================================================================
+ Copyright (2021), Tomer Shalev (tomer.shalev@gmail.com, https://github.com/HendrixString).
+ All Rights Reserved.
+ License is a custom open source semi-permissive license with the following guidelines:
+ 1. unless otherwise stated, derivative work and usage of this file is permitted and
+    should be credited to the project and the author of this project.
+ 2. Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+========================================================================================*/
+#pragma once
+
+#include <microgl/samplers/sampler.h>
+#include <microgl/samplers/texture.h>
+
+namespace microgl {
+    namespace sampling {
+        enum class mip_filter {
+            // the level closest to the footprint
+            Nearest,
+            // blend of the two levels around the footprint
+            Trilinear
+        };
+
+        /**
+         * a texture of a mip chain. rasterizers, that know the uv footprint of the pixels of
+         * a primitive, pick the level through level_of_detail() (see sampling::has_levels),
+         * minified primitives sample small levels, which is less aliased and keeps the working
+         * set in the cache. sampled directly, the texture samples level 0.
+         *
+         * @tparam MipChain the mip chain type, see mip_chain
+         * @tparam mip the filter between levels
+         * @tparam filter the filter inside a level
+         * @tparam tint tint the sampled colors
+         */
+        template <typename MipChain,
+                mip_filter mip=mip_filter::Nearest,
+                texture_filter filter=texture_filter::NearestNeighboor,
+                bool tint=false>
+        struct mipmap_texture {
+            using rgba = typename MipChain::rgba;
+            using uint8_t = microgl::ints::uint8_t;
+
+        private:
+            using rint = int;
+            using base_texture = texture<typename MipChain::base_type, filter, tint>;
+            using level_texture = texture<typename MipChain::level_type, filter, tint>;
+
+            static constexpr uint8_t r_max_val = (1u<<rgba::r) - 1;
+            static constexpr uint8_t g_max_val = (1u<<rgba::g) - 1;
+            static constexpr uint8_t b_max_val = (1u<<rgba::b) - 1;
+            static constexpr uint8_t a_max_val = (1u<<rgba::a) - 1;
+
+            // blend b into a with a weight of 8 bits
+            static void lerp(color_t & a, const color_t & b, const rint t) {
+                a.r = (rint(a.r)*(256-t) + rint(b.r)*t)>>8;
+                a.g = (rint(a.g)*(256-t) + rint(b.g)*t)>>8;
+                a.b = (rint(a.b)*(256-t) + rint(b.b)*t)>>8;
+                a.a = (rint(a.a)*(256-t) + rint(b.a)*t)>>8;
+            }
+
+            void sample_level(unsigned level, const rint u, const rint v, const uint8_t bits,
+                              color_t & output) const {
+                if(level==0) base_texture(&_chain->base(), _color_tint).sample(u, v, bits, output);
+                else level_texture(&_chain->level(level), _color_tint).sample(u, v, bits, output);
+            }
+
+            void sample_level_span(unsigned level, rint u, rint v, const rint du, const rint dv,
+                                   const uint8_t bits, unsigned count, color_t * output) const {
+                if(level==0) base_texture(&_chain->base(), _color_tint).sample_span(u, v, du, dv, bits, count, output);
+                else level_texture(&_chain->level(level), _color_tint).sample_span(u, v, du, dv, bits, count, output);
+            }
+
+        public:
+            /**
+             * the sampler of one level, or of two neighbouring levels with trilinear filtering
+             */
+            struct lod_type {
+                using rgba = typename MipChain::rgba;
+
+                const mipmap_texture * source;
+                unsigned level;
+                // weight of the next level, 8 bits
+                rint t;
+
+                inline void sample(const rint u, const rint v, const uint8_t bits, color_t & output) const {
+                    source->sample_level(level, u, v, bits, output);
+                    if(mip==mip_filter::Trilinear && t) { // compile time branching
+                        color_t next;
+                        source->sample_level(level+1, u, v, bits, next);
+                        lerp(output, next, t);
+                    }
+                }
+
+                /**
+                 * sample a span of pixels, see sampling::has_sample_span
+                 */
+                inline void sample_span(rint u, rint v, const rint du, const rint dv,
+                                        const uint8_t bits, unsigned count, color_t * output) const {
+                    source->sample_level_span(level, u, v, du, dv, bits, count, output);
+                    if(mip!=mip_filter::Trilinear || t==0) return;
+                    constexpr unsigned chunk = 32;
+                    color_t next[chunk];
+                    for (unsigned ix = 0; ix < count; ix+=chunk, u+=du*rint(chunk), v+=dv*rint(chunk)) {
+                        const unsigned n = count-ix < chunk ? count-ix : chunk;
+                        source->sample_level_span(level+1, u, v, du, dv, bits, n, next);
+                        for (unsigned jx = 0; jx < n; ++jx) lerp(output[ix+jx], next[jx], t);
+                    }
+                }
+            };
+
+            mipmap_texture() : mipmap_texture{nullptr, {r_max_val, g_max_val, b_max_val, a_max_val}} {};
+            mipmap_texture(MipChain * chain) : mipmap_texture{chain, {r_max_val, g_max_val, b_max_val, a_max_val}} {};
+            mipmap_texture(MipChain * chain, const color_t & tint_color) :
+                    _color_tint{tint_color}, _chain{chain} {};
+
+            void updateMipChain(MipChain * chain) { _chain=chain; }
+            MipChain & mipChain() { return *_chain; }
+            void updateTintColor(const color_t & color) { _color_tint=color; }
+
+            inline void sample(const rint u, const rint v, const uint8_t bits, color_t & output) const {
+                sample_level(0, u, v, bits, output);
+            }
+
+            /**
+             * the levels of a uv footprint, see sampling::has_levels. the footprint is measured
+             * in texels of level 0 by its longest delta, levels are in log2 of it with 8 bits of
+             * fraction, which approximates the log of the mantissa linearly.
+             */
+            lod_type level_of_detail(int du_dx, int dv_dx, int du_dy, int dv_dy, const uint8_t bits) const {
+                using int64 = microgl::ints::int64_t;
+                const int64 w = _chain->width(0), h = _chain->height(0);
+                int64 rho = (du_dx<0 ? -int64(du_dx) : int64(du_dx))*w;
+                const int64 footprint[3] = {(dv_dx<0 ? -int64(dv_dx) : int64(dv_dx))*h,
+                                            (du_dy<0 ? -int64(du_dy) : int64(du_dy))*w,
+                                            (dv_dy<0 ? -int64(dv_dy) : int64(dv_dy))*h};
+                for (int ix = 0; ix < 3; ++ix) rho = footprint[ix]>rho ? footprint[ix] : rho;
+                // magnified and texel sized footprints sample level 0
+                if(rho<=(int64(1)<<bits)) return {this, 0, 0};
+                unsigned e = bits;
+                while ((rho>>(e+1))!=0) ++e;
+                const rint fraction = rint((e>=8 ? rho>>(e-8) : rho<<(8-e)) - 256);
+                rint lod = rint(e-bits)*256 + fraction;
+                if(mip==mip_filter::Nearest) lod = (lod+128) & ~rint(255);
+                const unsigned level = unsigned(lod>>8), last = _chain->levels()-1;
+                if(level>=last) return {this, last, 0};
+                return {this, level, lod & 255};
+            }
+
+        private:
+            color_t _color_tint;
+            MipChain * _chain = nullptr;
+        };
+
+    }
+}
@@ -47,6 +47,124 @@ namespace microgl {
             sampler.sample(u_fixed, v_fixed, bits, output);
         }
 
+        /**
+         * fraction bits of the coords of a span, spans step their coords with more
+         * precision than the coords of pixels, so long spans do not drift
+         */
+        constexpr microgl::ints::uint8_t span_fraction_bits = 8;
+
+        /**
+         * compile time detection of samplers, that implement span sampling, a span sampler
+         * has a method of the form:
+         *
+         * void sample_span(int u, int v, int du, int dv, uint8_t bits,
+         *                  unsigned count, color_t * output) const
+         *
+         * which samples (count) pixels of a row. the coords and deltas have (bits + span_fraction_bits)
+         * bits of precision, the i-th color is the color of (u + i*du, v + i*dv), samplers either
+         * use the extra precision or sample ((u + i*du)>>span_fraction_bits, ...) in (bits) precision.
+         * setup work like wrapping, bitmap addressing and gradient stops search is done once per
+         * span and not per pixel.
+         * NOTE: the coords of a span are stepped linearly from its first pixel, so they may differ
+         * from the exact per pixel coords by up to one unit of (bits) precision, which may pick a
+         * neighbouring texel. span sampling is therefore not bit exact with per pixel sampling.
+         *
+         * @tparam Sampler the sampler type
+         */
+        template<class Sampler>
+        struct has_sample_span {
+        private:
+            template<class S>
+            static char test(decltype(((const S *)nullptr)->sample_span(0, 0, 0, 0,
+                            microgl::ints::uint8_t(0), 0u, (color_t *)nullptr)) *);
+            template<class S>
+            static long test(...);
+        public:
+            static constexpr bool value = sizeof(test<Sampler>(nullptr))==sizeof(char);
+        };
+
+        template<class Sampler, bool span=has_sample_span<Sampler>::value>
+        struct span_sampling {
+            static inline void sample_span(const Sampler & sampler, int u, int v, int du, int dv,
+                                           const microgl::ints::uint8_t bits, unsigned count, color_t * output) {
+                sampler.sample_span(u, v, du, dv, bits, count, output);
+            }
+        };
+
+        template<class Sampler>
+        struct span_sampling<Sampler, false> {
+            static inline void sample_span(const Sampler & sampler, int u, int v, int du, int dv,
+                                           const microgl::ints::uint8_t bits, unsigned count, color_t * output) {
+                for (unsigned ix = 0; ix < count; ++ix, u+=du, v+=dv)
+                    sampler.sample(u>>span_fraction_bits, v>>span_fraction_bits, bits, output[ix]);
+            }
+        };
+
+        /**
+         * sample a span of pixels, uses the sampler's sample_span() if it has one and
+         * falls back to sampling pixel by pixel otherwise.
+         *
+         * @param sampler the sampler reference
+         * @param u the u coord of the first pixel, with span_fraction_bits extra bits
+         * @param v the v coord of the first pixel, with span_fraction_bits extra bits
+         * @param du the u delta between consecutive pixels, with span_fraction_bits extra bits
+         * @param dv the v delta between consecutive pixels, with span_fraction_bits extra bits
+         * @param bits the precision of the sampled coords
+         * @param count the number of pixels
+         * @param output the output colors, at least (count) of them
+         */
+        template<class Sampler>
+        inline void sample_span(const Sampler & sampler, int u, int v, int du, int dv,
+                                const microgl::ints::uint8_t bits, unsigned count, color_t * output) {
+            span_sampling<Sampler>::sample_span(sampler, u, v, du, dv, bits, count, output);
+        }
+
+        /**
+         * compile time detection of samplers, that have levels of detail, like mip maps, a levels
+         * sampler has a type lod_type and a method of the form:
+         *
+         * lod_type level_of_detail(int du_dx, int dv_dx, int du_dy, int dv_dy, uint8_t bits) const
+         *
+         * which returns a sampler of the levels, that fit the uv footprint of a pixel. the footprint
+         * is the uv deltas of a step of one pixel in x and in y, in (bits) precision. rasterizers,
+         * that know the footprint of a primitive, sample the returned sampler instead.
+         *
+         * @tparam Sampler the sampler type
+         */
+        template<class Sampler>
+        struct has_levels {
+        private:
+            template<class S>
+            static char test(decltype(((const S *)nullptr)->level_of_detail(0, 0, 0, 0,
+                            microgl::ints::uint8_t(0))) *);
+            template<class S>
+            static long test(...);
+        public:
+            static constexpr bool value = sizeof(test<Sampler>(nullptr))==sizeof(char);
+        };
+
+        /**
+         * the sampler of the levels of detail of a footprint, samplers without levels are
+         * their own levels sampler
+         */
+        template<class Sampler, bool lod=has_levels<Sampler>::value>
+        struct levels {
+            using type = typename Sampler::lod_type;
+            static inline type of(const Sampler & sampler, int du_dx, int dv_dx, int du_dy, int dv_dy,
+                                  const microgl::ints::uint8_t bits) {
+                return sampler.level_of_detail(du_dx, dv_dx, du_dy, dv_dy, bits);
+            }
+        };
+
+        template<class Sampler>
+        struct levels<Sampler, false> {
+            using type = Sampler;
+            static inline const Sampler & of(const Sampler & sampler, int, int, int, int,
+                                             const microgl::ints::uint8_t) {
+                return sampler;
+            }
+        };
+
         /**
          * a base sampler container, includes a utility methods and crpt
          * routing for compile time polymorphism
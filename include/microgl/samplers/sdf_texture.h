@@ -0,0 +1,113 @@
+/*========================================================================================
+ Copyright (2021), Tomer Shalev (tomer.shalev@gmail.com, https://github.com/HendrixString).
+ All Rights Reserved.
+ License is a custom open source semi-permissive license with the following guidelines:
+ 1. unless otherwise stated, derivative work and usage of this file is permitted and
+    should be credited to the project and the author of this project.
+ 2. Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+========================================================================================*/
+#pragma once
+
+#include <microgl/samplers/sampler.h>
+
+namespace microgl {
+    namespace sampling {
+
+        /**
+         * a texture of a signed distance field, see text::sdf_converter. distances are 8 bits
+         * in the red channel of the bitmap (the alpha channel if it has no red), 128 is the edge
+         * and bigger values are inside. the distance is sampled bilinearly and the coverage of
+         * the pixel is a smoothstep of it over the width of a pixel, so the edges stay sharp at
+         * any scale. the sampled color is the color of the texture with the coverage in alpha.
+         *
+         * @tparam Bitmap the bitmap of distances
+         */
+        template <typename Bitmap>
+        struct sdf_texture {
+            using rgba = rgba_t<8,8,8,8>;
+            using uint8_t = microgl::ints::uint8_t;
+
+        private:
+            using rint = int;
+            using bitmap_rgba = typename Bitmap::rgba;
+            static constexpr unsigned bits_of_distance = bitmap_rgba::r ? bitmap_rgba::r : bitmap_rgba::a;
+            static_assert(bits_of_distance>0, "the bitmap has no red or alpha channel");
+
+            static rint distance_of(const Bitmap & bitmap, const rint x, const rint y) {
+                color_t color;
+                bitmap.decode(x, y, color);
+                const rint value = bitmap_rgba::r ? color.r : color.a;
+                return bits_of_distance==8 ? value : (value*255)/((1<<bits_of_distance)-1);
+            }
+
+        public:
+            /**
+             * the distance of a point of a bitmap, bilinearly sampled between the centers of pixels
+             *
+             * @param x the x coordinate in pixels, with (bits) of fraction
+             * @param y the y coordinate in pixels, with (bits) of fraction
+             */
+            static rint distance(const Bitmap & bitmap, rint x, rint y, const uint8_t bits) {
+                const rint one = rint(1)<<bits, half = one>>1;
+                const rint x_max = rint(bitmap.width()-1)<<bits, y_max = rint(bitmap.height()-1)<<bits;
+                x -= half; y -= half;
+                x = x<0 ? 0 : (x>x_max ? x_max : x); y = y<0 ? 0 : (y>y_max ? y_max : y);
+                const rint X = x>>bits, Y = y>>bits;
+                const rint X1 = X<bitmap.width()-1 ? X+1 : X, Y1 = Y<bitmap.height()-1 ? Y+1 : Y;
+                // the fractions in 8 bits keep the products in 32 bits
+                const rint tx = bits>=8 ? (x&(one-1))>>(bits-8) : (x&(one-1))<<(8-bits);
+                const rint ty = bits>=8 ? (y&(one-1))>>(bits-8) : (y&(one-1))<<(8-bits);
+                const rint top = distance_of(bitmap, X, Y)*(256-tx) + distance_of(bitmap, X1, Y)*tx;
+                const rint bottom = distance_of(bitmap, X, Y1)*(256-tx) + distance_of(bitmap, X1, Y1)*tx;
+                return (top*(256-ty) + bottom*ty + (1<<15))>>16;
+            }
+
+            /**
+             * half of the width of a pixel in distance units, for a field of a spread, that is
+             * drawn at a scale
+             *
+             * @param spread the spread of the field in pixels
+             * @param scale the scale, (precision) bits
+             * @param precision the bits of the scale
+             */
+            static rint half_width(const rint spread, const rint scale, const uint8_t precision) {
+                const rint width = (rint(64)<<precision)/(spread*scale);
+                return width>0 ? width : 1;
+            }
+
+            /**
+             * the coverage of a distance, a smoothstep over the width of a pixel around the edge, 8 bits
+             */
+            static uint8_t coverage(const rint distance, const rint half_width) {
+                const rint t = distance-128;
+                if(t<=-half_width) return 0;
+                if(t>=half_width) return 255;
+                const rint x = ((t+half_width)*255)/(2*half_width);
+                return uint8_t((x*x*(765-2*x))/65025);
+            }
+
+            sdf_texture() : sdf_texture{nullptr, {255, 255, 255, 255}, 1} {};
+            sdf_texture(Bitmap * bitmap, const color_t & color, const rint half_width) :
+                    _color{color}, _bmp{bitmap}, _half_width{half_width} {};
+
+            void updateBitmap(Bitmap * bitmap) { _bmp=bitmap; }
+            Bitmap & bitmap() { return *_bmp; }
+            void updateColor(const color_t & color) { _color=color; }
+            void updateHalfWidth(const rint half_width) { _half_width=half_width; }
+
+            inline void sample(const rint u, const rint v, const uint8_t bits, color_t & output) const {
+                const rint d = distance(*_bmp, u*_bmp->width(), v*_bmp->height(), bits);
+                output = _color;
+                output.a = (rint(_color.a)*coverage(d, _half_width) + 127)/255;
+            }
+
+        private:
+            color_t _color;
+            Bitmap * _bmp = nullptr;
+            rint _half_width = 1;
+        };
+
+    }
+}
@@ -122,7 +122,7 @@ namespace microgl {
                 const rint half= rint(1)<<(bits-1);
                 const rint x = (rint(_bmp->width()-1)*(u)+half) >> bits;
                 const rint y = (rint(_bmp->height()-1)*(v)+half) >> bits;
-                const int index_bmp = y*_bmp->width() + x;
+                const int index_bmp = y*_bmp->stride() + x;
                 _bmp->decode(index_bmp, output);
                 if(tint) tint_color(output, _color_tint);
 //                output={0,0,0,255};
@@ -130,10 +130,64 @@ namespace microgl {
 
             inline void sample_bilinear(rint u, rint v,
                                const uint8_t bits, color_t &output) const {
+                sample_bilinear_scaled(u*(_bmp->width()-1), v*(_bmp->height()-1), bits, output);
+            }
+
+            /**
+             * sample a span of pixels, see sampling::has_sample_span. wrapping and bitmap
+             * dimensions are resolved once per span, wrapped textures are sampled pixel by pixel.
+             * nearest neighboor steps the texel coords with the fraction bits of the span, and
+             * rows of constant v decode the pixels of a single row of the bitmap.
+             */
+            inline void sample_span(rint u, rint v, const rint du, const rint dv,
+                                    const uint8_t bits, unsigned count, color_t *output) const {
+                constexpr uint8_t F = span_fraction_bits;
+                if(wrap_u!=texture_wrap::None || wrap_v!=texture_wrap::None) { // compile time branching
+                    for (unsigned ix = 0; ix < count; ++ix, u+=du, v+=dv)
+                        sample(u>>F, v>>F, bits, output[ix]);
+                    return;
+                }
+                const rint bmp_w_max = _bmp->width()-1, bmp_h_max = _bmp->height()-1;
+                if(filter==texture_filter::NearestNeighboor) // compile time branching
+                    sample_span_nearest_neighboor(u, v, du, dv, bits, count, output);
+                else if(filter==texture_filter::Bilinear) {
+                    for (unsigned ix = 0; ix < count; ++ix, u+=du, v+=dv)
+                        sample_bilinear_scaled((u>>F)*bmp_w_max, (v>>F)*bmp_h_max, bits, output[ix]);
+                }
+            }
+
+        private:
+            inline void sample_span_nearest_neighboor(const rint u, const rint v, const rint du, const rint dv,
+                                                      const uint8_t bits, unsigned count, color_t *output) const {
+                using rint_big = microgl::ints::int64_t;
+                const uint8_t shift = bits + span_fraction_bits;
+                const rint_big half = rint_big(1)<<(shift-1);
+                const rint_big bmp_w_max = _bmp->width()-1, bmp_h_max = _bmp->height()-1;
+                // texel coords with (bits + span_fraction_bits) fraction bits
+                rint_big x = bmp_w_max*u + half, y = bmp_h_max*v + half;
+                const rint_big dx = bmp_w_max*du, dy = bmp_h_max*dv;
+                const rint pitch = _bmp->stride();
+                const auto & bmp = *_bmp;
+                const auto & coder = bmp.coder();
+                if(dy==0) { // the span reads a single row
+                    const rint row = rint(y>>shift)*pitch;
+                    for (unsigned ix = 0; ix < count; ++ix, x+=dx) {
+                        coder.decode(bmp.pixelAt(row + rint(x>>shift)), output[ix]);
+                        if(tint) tint_color(output[ix], _color_tint);
+                    }
+                    return;
+                }
+                for (unsigned ix = 0; ix < count; ++ix, x+=dx, y+=dy) {
+                    coder.decode(bmp.pixelAt(rint(y>>shift)*pitch + rint(x>>shift)), output[ix]);
+                    if(tint) tint_color(output[ix], _color_tint);
+                }
+            }
+
+            // bilinear sampling of coordinates, that were scaled by the (bitmap dimensions - 1)
+            inline void sample_bilinear_scaled(const rint u, const rint v,
+                               const uint8_t bits, color_t &output) const {
                 const rint bmp_w_max = _bmp->width()-1;
                 const rint bmp_h_max = _bmp->height()-1;
-                u=u*bmp_w_max;
-                v=v*bmp_h_max;
                 const rint max = rint(1) << bits;
                 const rint max_value = max - 1;
 //                rint mask = ~max_value;
@@ -176,7 +230,6 @@ namespace microgl {
                 if(tint) tint_color(output, _color_tint);
             }
 
-        private:
             color_t _border_color {0,0,0, a_max_val};
             color_t _color_tint ;
             Bitmap * _bmp= nullptr;
@@ -34,6 +34,15 @@ namespace microgl {
             struct varying {
                 microgl::color_t color{255,0,0};
 
+                // layout for incremental interpolation, see varying_layout
+                static constexpr unsigned components= 4;
+                number get(unsigned index) const {
+                    return index==0 ? color.r : index==1 ? color.g : index==2 ? color.b : color.a;
+                }
+                void set(unsigned index, const number & value) {
+                    (index==0 ? color.r : index==1 ? color.g : index==2 ? color.b : color.a) = int(value);
+                }
+
                 // you must implement the interpolation function
 //                template <typename bary_integer>
                 void interpolate(const varying &varying_a,
@@ -31,6 +31,11 @@ namespace microgl {
             struct varying {
                 vertex2<number> uv;
 
+                // layout for incremental interpolation, see varying_layout
+                static constexpr unsigned components= 2;
+                number get(unsigned index) const { return index ? uv.y : uv.x; }
+                void set(unsigned index, const number & value) { (index ? uv.y : uv.x) = value; }
+
                 void interpolate(const varying &varying_a,
                                  const varying &varying_b,
                                  const varying &varying_c,
@@ -14,6 +14,7 @@
 #include "microgl/math/vertex3.h"
 #include "microgl/math/vertex4.h"
 #include "../color.h"
+#include "../traits.h"
 
 namespace microgl {
     namespace shading {
@@ -30,6 +31,36 @@ namespace microgl {
         template<class shader>
         using shader_rgba = typename shader::rgba;
 
+        /**
+         * the layout of a varying. a varying, that describes itself as a fixed number of linear
+         * components with:
+         *   static constexpr unsigned components= N;
+         *   number get(unsigned index) const;
+         *   void set(unsigned index, const number & value);
+         * is interpolated incrementally by the rasterizer, that computes the gradients of its
+         * components once per triangle. other varying are interpolated with interpolate() per pixel.
+         * incremental interpolation is an approximation, the components are exact at the start of
+         * every row and accumulate rounding along it, so they may be off by up to a texel from
+         * interpolate(). omit the layout for varying, that must be exact
+         */
+        template<class varying, class=void>
+        struct varying_layout {
+            static constexpr unsigned components= 0;
+            template<typename number>
+            static number get(const varying &, unsigned) { return number(0); }
+            template<typename number>
+            static void set(varying &, unsigned, const number &) {}
+        };
+
+        template<class varying>
+        struct varying_layout<varying, typename microgl::traits::enable_if<(varying::components>0)>::type> {
+            static constexpr unsigned components= varying::components;
+            template<typename number>
+            static number get(const varying & v, unsigned index) { return number(v.get(index)); }
+            template<typename number>
+            static void set(varying & v, unsigned index, const number & value) { v.set(index, value); }
+        };
+
         template<typename rgba_, typename impl, typename vertex_attr, typename varying, typename number>
         class shader_base : public microgl::traits::crpt<impl> {
         protected:
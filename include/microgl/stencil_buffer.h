@@ -0,0 +1,49 @@
+/*========================================================================================
+ Copyright (2021), Tomer Shalev (tomer.shalev@gmail.com, https://github.com/HendrixString).
+ All Rights Reserved.
+ License is a custom open source semi-permissive license with the following guidelines:
+ 1. unless otherwise stated, derivative work and usage of this file is permitted and
+    should be credited to the project and the author of this project.
+ 2. Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+========================================================================================*/
+#pragma once
+
+#include "./stdint.h"
+#include "traits.h"
+
+namespace microgl {
+    /**
+     * an 8 bit stencil buffer. values wrap around when incremented and decremented, like
+     * the wrapping stencil operations of gpus, so winding numbers are kept modulo 256
+     *
+     * @tparam Allocator the allocator of the values
+     */
+    template<class Allocator=microgl::traits::std_rebind_allocator<>>
+    class stencil_buffer {
+    public:
+        using value_type = microgl::ints::uint8_t;
+        using allocator_type = typename Allocator::template rebind<value_type>::other;
+    private:
+        allocator_type _allocator;
+        value_type *_data = nullptr;
+        int _w = 0, _h = 0, _size = 0;
+    public:
+        explicit stencil_buffer(int w, int h, const Allocator &allocator = Allocator()) :
+                _allocator(allocator), _data(_allocator.allocate(w * h)), _w{w}, _h{h}, _size{w * h} {
+            clear();
+        }
+        ~stencil_buffer() { _allocator.deallocate(_data); }
+        int width() const { return _w; }
+        int height() const { return _h; }
+        int size() const { return _size; }
+        const value_type &operator[](int index) const { return _data[index]; }
+        value_type &operator[](int index) { return _data[index]; }
+        const value_type &operator()(int x, int y) const { return _data[y * _w + x]; }
+        value_type &operator()(int x, int y) { return _data[y * _w + x]; }
+        value_type *data() { return _data; }
+        void fill(const int &value) { for (int ix = 0; ix < _size; ++ix) _data[ix] = value_type(value); }
+        void clear() { fill(0); }
+    };
+}
@@ -12,6 +12,8 @@
 
 #include "bitmap_glyph.h"
 #include "text_format.h"
+#include "../color.h"
+#include "../stdint.h"
 
 namespace microgl {
     namespace text {
@@ -23,6 +25,10 @@ namespace microgl {
             int scale=1; int precision=0;
             int end_index=0;
             char_location * locations=nullptr;
+            // index of the char, that the next chunk of the layout starts at, -1 if the layout is done
+            int next_index=-1;
+            // where the next chunk continues, unscaled with (precision) bits
+            int next_y=0, v_offset=0;
         };
 
         /**
@@ -40,6 +46,20 @@ namespace microgl {
             bitmap_glyph char_missing =
                     bitmap_glyph{CHAR_MISSING, 0, 0, 0, 0, 0, 0, 0};
             int count_internal = 0;
+            // glyphs by id, ascii ids are direct mapped and others are open addressed by a hash,
+            // entries are (index of glyph + 1) and 0 is empty
+            static constexpr unsigned ASCII = 128;
+            static constexpr unsigned table_size(unsigned size=1) {
+                return size>=2*MAX_CHARS ? size : table_size(size<<1);
+            }
+            static constexpr unsigned HASHED = table_size();
+            int ascii_table[ASCII] = {};
+            int hashed_table[HASHED] = {};
+            static unsigned hash(int id) {
+                unsigned h = unsigned(id);
+                h ^= h>>16; h *= 0x45d9f3bu; h ^= h>>16;
+                return h & (HASHED-1);
+            }
         public:
             /** The name of the font as it was parsed from_sampler the font file. */
             char name[20]={};
@@ -62,27 +82,193 @@ namespace microgl {
             int padding = 0;
             int glyphs_count = 0;
             int width=0, height=0;
+            /** The spread in pixels of a signed distance field font, whose bitmap holds distances
+              *  to the edges of the glyphs instead of colors, see sdf_converter. 0 for a regular font. */
+            int sdf_spread = 0;
             bitmap_type * bitmap = nullptr;
             bitmap_glyph gylphs[MAX_CHARS];
 
         public:
             bitmap_font() { addChar(CHAR_MISSING, 0,0,0,0,0,0,0); }
 
+            /**
+             * add a glyph, glyphs are looked up by tables, that are updated here, so glyphs
+             * are added with this method. the first glyph of an id is the one found.
+             */
             void addChar(int id, int x, int y, int w, int h, int xOffset, int yOffset, int xAdvance) {
                 gylphs[count_internal++] = bitmap_glyph{id, x, y, w, h, xOffset, yOffset, xAdvance};
+                if(id>=0 && id<int(ASCII)) {
+                    if(ascii_table[id]==0) ascii_table[id] = count_internal;
+                    return;
+                }
+                for (unsigned ix = hash(id); ; ix = (ix+1) & (HASHED-1)) {
+                    if(hashed_table[ix]==0) { hashed_table[ix] = count_internal; return; }
+                    if(gylphs[hashed_table[ix]-1].id==id) return;
+                }
+            }
+
+            // number of glyphs, including the missing glyph at index 0
+            int charsCount() const { return count_internal; }
+
+            /**
+             * the coverage of a pixel of the bitmap of a regular font, its alpha or its brightest
+             * channel if the bitmap has no alpha, 8 bits
+             */
+            microgl::ints::uint8_t coverage(int x, int y) const {
+                using rgba = typename bitmap_type::rgba;
+                using uint8_t = microgl::ints::uint8_t;
+                microgl::color_t color;
+                bitmap->decode(x, y, color);
+                constexpr int r_max = rgba::r ? (1<<rgba::r)-1 : 1, g_max = rgba::g ? (1<<rgba::g)-1 : 1,
+                              b_max = rgba::b ? (1<<rgba::b)-1 : 1, a_max = rgba::a ? (1<<rgba::a)-1 : 1;
+                if(rgba::a) return uint8_t((int(color.a)*255 + (a_max>>1))/a_max);
+                const int r = rgba::r ? (int(color.r)*255)/r_max : 0, g = rgba::g ? (int(color.g)*255)/g_max : 0,
+                          b = rgba::b ? (int(color.b)*255)/b_max : 0;
+                return uint8_t(r>g ? (r>b ? r : b) : (g>b ? g : b));
             }
 
             bitmap_glyph *charByID(int id) {
-                for (int ix = 0; ix < count_internal; ++ix)
-                    if (gylphs[ix].id == id) return &gylphs[ix];
+                if(id>=0 && id<int(ASCII))
+                    return ascii_table[id] ? &gylphs[ascii_table[id]-1] : nullptr;
+                for (unsigned ix = hash(id); hashed_table[ix]; ix = (ix+1) & (HASHED-1))
+                    if(gylphs[hashed_table[ix]-1].id==id) return &gylphs[hashed_table[ix]-1];
                 return nullptr;
             }
 
+        private:
+            /**
+             * layout lines from the char at index (from), until the text ends, the lines do not fit
+             * the container or the next line does not fit the locations buffer. a line longer
+             * than the buffer is broken where the buffer ends.
+             *
+             * @param locations the buffer of locations, null to only measure the lines
+             * @param capacity size of the buffer, -1 if unbounded
+             * @param current_y y of the first line, updated to the y after the last line
+             * @param next index of the char, that the next chunk starts at, or -1 if the layout is done
+             *
+             * @return number of locations
+             */
+            int layout_lines(const char * text, int from, int numChars, int containerWidth,
+                             int containerHeight, const text_format & format,
+                             char_location * locations, int capacity, int & current_y, int & next) {
+                const int PP=4;
+                const int size=nativeSize<<PP;
+                int currentX=0, currentY=current_y;
+                int start_loc_index=-1, loc_idx=0, line_start=from;
+                int lastWhiteSpace=-1, lastCharID=-1;
+                next=-1;
+                if (size > containerHeight) return 0;
+                for (int ix=from; ix<numChars; ++ix)
+                {
+                    bool lineFull = false, buffer_full = false;
+                    int charID = text[ix];
+                    auto *bitmap_char = charByID(charID);
+                    if (charID == CHAR_NEWLINE || charID == CHAR_CARRIAGE_RETURN)
+                        lineFull = true;
+                    else if (capacity>=0 && loc_idx==capacity) {
+                        if (start_loc_index!=0) { // the line starts over in the next chunk
+                            if (start_loc_index>0) loc_idx=start_loc_index;
+                            next=line_start; current_y=currentY;
+                            return loc_idx;
+                        }
+                        buffer_full = lineFull = true; --ix; // break the line before this char
+                    }
+                    else {
+                        if (bitmap_char == nullptr) {
+                            charID = CHAR_MISSING;
+                            bitmap_char = &char_missing;
+                        }
+
+                        if (charID==CHAR_SPACE || charID==CHAR_TAB) lastWhiteSpace = ix;
+//                        if (kerning)
+//                            currentX += char.getKerning(lastCharID);
+
+                        if(start_loc_index==-1) start_loc_index=loc_idx;
+                        char_location loc;
+                        loc.character=bitmap_char;
+                        loc.x = currentX + (bitmap_char->xOffset<<PP);
+                        loc.y = currentY + (bitmap_char->yOffset<<PP);
+                        if (locations) locations[loc_idx] = loc;
+                        loc_idx++;
+                        currentX += (bitmap_char->xAdvance + format.letterSpacing)<<PP;
+                        lastCharID = charID;
+                        bool does_overflow=loc.x + ((bitmap_char->width)<<PP) > containerWidth;
+                        if (does_overflow) {
+                            switch (format.wordWrap) {
+                                case wordWrap::break_word:
+                                {
+                                    // remove characters and add them again to next line
+                                    int numCharsToRemove = lastWhiteSpace == -1 ? 1 : ix - lastWhiteSpace;
+                                    if ((loc_idx-=numCharsToRemove)==0) break;
+                                    ix -= numCharsToRemove;
+                                    break;
+                                }
+                                case wordWrap::normal:
+                                {
+                                    loc_idx-=1;
+                                    // continue with next line, if there is one
+                                    while (ix++<numChars-1 && text[ix]!=CHAR_NEWLINE && text[ix]!=CHAR_SPACE
+                                                                                        && text[ix]!=CHAR_TAB);
+                                    break;
+                                }
+                            }
+                            lineFull = true;
+                        }
+                    }
+
+                    const bool finished = ix>=numChars-1 && !buffer_full;
+                    if (finished) lineFull=true; //tomer
+
+                    if (lineFull) {
+                        int end_loc_index=loc_idx-1;
+                        if (lastWhiteSpace==ix) end_loc_index-=1;
+                        if (locations && format.horizontalAlign!=hAlign::left &&
+                                start_loc_index>=0 && end_loc_index>=start_loc_index) {
+                            int layoutOffset=0;
+                            const auto last_char_loc=locations[end_loc_index];
+                            layoutOffset = last_char_loc.x- ((last_char_loc.character->xOffset-
+                                    last_char_loc.character->xAdvance)<<PP);
+                            layoutOffset= containerWidth-layoutOffset;
+                            if (format.horizontalAlign==hAlign::center) layoutOffset/=2;
+                            for (int jj=start_loc_index; jj<=end_loc_index; ++jj)
+                                locations[jj].x+=layoutOffset;
+                        }
+                        currentX = 0; currentY += (lineHeight + format.leading)<<PP;
+                        start_loc_index=lastCharID=lastWhiteSpace = -1;
+                        line_start=ix+1;
+                        if ((currentY + size+ ((lineHeight + format.leading)<<PP)) > containerHeight)
+                            break;
+                        if (finished) break;
+                    }
+                } // for each char
+                current_y=currentY;
+                return loc_idx;
+            }
+
+        public:
+            /**
+             * layout a text inside a box. the layout is written into a buffer of locations, texts,
+             * that need more locations than the buffer has, are laid out in chunks of whole lines,
+             * the result of a chunk tells where the next chunk starts (next_index) and is passed
+             * to lay out the next chunk.
+             *
+             * @param text the text
+             * @param numChars number of chars of the text
+             * @param box_width width of the box
+             * @param box_height height of the box
+             * @param format the text format
+             * @param locations_buffer the buffer of locations
+             * @param capacity size of the buffer, -1 if it is big enough for any text
+             * @param previous the result of the previous chunk, null for the first chunk
+             *
+             * @return the layout of the chunk
+             */
             text_layout_result layout_text(
                     const char * text, int numChars,
                     int box_width, int box_height,
-                    text_format format,
-                    char_location * locations_buffer)
+                    const text_format & format,
+                    char_location * locations_buffer, int capacity=-1,
+                    const text_layout_result * previous=nullptr)
             {
                 int PP=4;
                 text_layout_result result;
@@ -90,117 +276,36 @@ namespace microgl {
                 result.precision=PP;
                 if (text == nullptr || numChars == 0) return result;
 
-                int fontSize = format.fontSize<0 ? nativeSize : format.fontSize;
-                bool autoScale = false;
-                bool finished = false;
-                int containerWidth, containerHeight;
-                int scale=0;
-                int size=nativeSize<<PP;
-                int currentX=0, currentY=0;
-                int start_loc_index=-1, loc_idx=0;
-                while (!finished)
-                {
-                    scale = (fontSize<<PP) / nativeSize;
-                    containerWidth  = (((box_width - 2 * padding) << PP) << PP) / scale;
-                    containerHeight = (((box_height - 2 * padding) << PP) << PP) / scale;
-                    if (size <= containerHeight) // && autoScale
-                    {
-                        int lastWhiteSpace=-1, lastCharID=-1;
-                        for (int ix=0; ix<numChars; ++ix)
-                        {
-                            bool lineFull = false;
-                            int charID = text[ix];
-                            auto *bitmap_char = charByID(charID);
-                            if (charID == CHAR_NEWLINE || charID == CHAR_CARRIAGE_RETURN)
-                                lineFull = true;
-                            else {
-                                if (bitmap_char == nullptr) {
-                                    charID = CHAR_MISSING;
-                                    bitmap_char = &char_missing;
-                                }
-
-                                if (charID==CHAR_SPACE || charID==CHAR_TAB) lastWhiteSpace = ix;
-//                                if (kerning)
-//                                    currentX += char.getKerning(lastCharID);
-
-                                if(start_loc_index==-1) start_loc_index=loc_idx;
-                                char_location & loc = locations_buffer[loc_idx++];
-                                loc.character=bitmap_char;
-                                loc.x = currentX + (bitmap_char->xOffset<<PP);
-                                loc.y = currentY + (bitmap_char->yOffset<<PP);
-                                currentX += (bitmap_char->xAdvance + format.letterSpacing)<<PP;
-                                lastCharID = charID;
-                                bool does_overflow=loc.x + ((bitmap_char->width)<<PP) > containerWidth;
-                                if (does_overflow) {
-                                    switch (format.wordWrap) {
-                                        case wordWrap::break_word:
-                                        {
-                                            // when autoscaling, we must not split a word in half -> restart
-                                            if (autoScale && lastWhiteSpace == -1) break;
-                                            // remove characters and add them again to next line
-                                            int numCharsToRemove = lastWhiteSpace == -1 ? 1 : ix - lastWhiteSpace;
-                                            if ((loc_idx-=numCharsToRemove)==0) break;
-                                            ix -= numCharsToRemove;
-                                            break;
-                                        }
-                                        case wordWrap::normal:
-                                        {
-                                            if (autoScale) break;
-                                            loc_idx-=1;
-                                            // continue with next line, if there is one
-                                            while (ix++<numChars-1 && text[ix]!=CHAR_NEWLINE && text[ix]!=CHAR_SPACE
-                                                                                                && text[ix]!=CHAR_TAB);
-                                            break;
-                                        }
-                                    }
-                                    lineFull = true;
-                                }
-                            }
-
-                            if (ix==numChars-1) {
-                                finished = true;
-                                lineFull=true; //tomer
-                            }
-
-                            if (lineFull) {
-                                int end_loc_index=loc_idx-1;
-                                if (lastWhiteSpace==ix) end_loc_index-=1;
-                                if (format.horizontalAlign!=hAlign::left) {
-                                    int layoutOffset=0;
-                                    const auto last_char_loc=locations_buffer[end_loc_index];
-                                    layoutOffset = last_char_loc.x- ((last_char_loc.character->xOffset-
-                                            last_char_loc.character->xAdvance)<<PP);
-                                    layoutOffset= containerWidth-layoutOffset;
-                                    if (format.horizontalAlign==hAlign::center) layoutOffset/=2;
-                                    for (int jj=start_loc_index; jj<=end_loc_index; ++jj)
-                                        locations_buffer[jj].x+=layoutOffset;
-                                }
-                                currentX = 0; currentY += (lineHeight + format.leading)<<PP;
-                                start_loc_index=lastCharID=lastWhiteSpace = -1;
-                                if ((currentY + size+ ((lineHeight + format.leading)<<PP)) > containerHeight)
-                                    break;
-                            }
-                        } // for each char
-                    } // if (_lineHeight <= containerHeight)
-
-                    if (autoScale && !finished && fontSize > 3) fontSize -= (1<<PP);
-                    else finished = true;
-                } // while (!finished)
-
+                const int fontSize = format.fontSize<0 ? nativeSize : format.fontSize;
+                const int scale = (fontSize<<PP) / nativeSize;
+                const int containerWidth  = (((box_width - 2 * padding) << PP) << PP) / scale;
+                const int containerHeight = (((box_height - 2 * padding) << PP) << PP) / scale;
+                int currentY = previous ? previous->next_y : 0, next;
+                const int count = layout_lines(text, previous ? previous->next_index : 0, numChars,
+                                               containerWidth, containerHeight, format,
+                                               locations_buffer, capacity, currentY, next);
                 int layout_v_offset=0;
-                if (format.verticalAlign!=vAlign::top) {
+                if (previous) layout_v_offset = previous->v_offset;
+                else if (format.verticalAlign!=vAlign::top) {
+                    // the bottom of the whole text, the rest of the chunks are measured
                     int bottom=currentY;// + (lineHeight<<PP);
+                    for (int ix=next; ix>=0; )
+                        layout_lines(text, ix, numChars, containerWidth, containerHeight, format,
+                                     nullptr, -1, bottom, ix);
                     layout_v_offset = containerHeight - bottom; // bottom
                     if (format.verticalAlign==vAlign::center) layout_v_offset/=2;
                 }
-                for (int jj=0; jj<loc_idx; ++jj) {
+                for (int jj=0; jj<count; ++jj) {
                     auto & char_final_loc=locations_buffer[jj];
                     char_final_loc.x = (scale * (char_final_loc.x + (offsetX<<PP)))>>PP;
                     char_final_loc.y = (scale * (char_final_loc.y + layout_v_offset + (offsetY<<PP)))>>PP;
                     char_final_loc.x += (padding<<PP); char_final_loc.y += (padding<<PP);
                 }
                 result.scale=scale;
-                result.end_index=loc_idx;
+                result.end_index=count;
+                result.next_index=next;
+                result.next_y=currentY;
+                result.v_offset=layout_v_offset;
                 return result;
             }
         };
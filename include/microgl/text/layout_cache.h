@@ -0,0 +1,132 @@
+/*========================================================================================
+ Copyright (2021), Tomer Shalev (tomer.shalev@gmail.com, https://github.com/HendrixString).
+ All Rights Reserved.
+ License is a custom open source semi-permissive license with the following guidelines:
+ 1. unless otherwise stated, derivative work and usage of this file is permitted and
+    should be credited to the project and the author of this project.
+ 2. Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+========================================================================================*/
+#pragma once
+
+#include "bitmap_font.h"
+#include "text_format.h"
+#include "../traits.h"
+
+namespace microgl {
+    namespace text {
+
+        /**
+         * a cache of text layouts, so static labels are laid out once. a layout is keyed by
+         * the font, the text, the box and the text format, the text is copied and compared on
+         * a hit, so texts may change between draws. layouts, that are laid out in chunks, are
+         * not cached. the cache is direct mapped by the hash of the text into (entries) layouts.
+         * locations point at the glyphs of the font, so clear the cache after glyphs are added
+         * to a font, that is cached.
+         *
+         * @tparam entries number of cached layouts, a power of 2
+         * @tparam Allocator the allocator of the texts and locations
+         */
+        template<unsigned entries=16, class Allocator=microgl::traits::std_rebind_allocator<>>
+        class layout_cache {
+            static_assert(entries>0 && (entries&(entries-1))==0, "entries must be a power of 2");
+
+            struct entry {
+                const void * font=nullptr;
+                unsigned hash=0;
+                int size=0, box_width=0, box_height=0;
+                text_format format;
+                char * text=nullptr;
+                text_layout_result result;
+            };
+            using char_allocator = typename Allocator::template rebind<char>::other;
+            using location_allocator = typename Allocator::template rebind<char_location>::other;
+            char_allocator _char_allocator;
+            location_allocator _location_allocator;
+            entry _entries[entries];
+
+            void release(entry & e) {
+                if(e.text) _char_allocator.deallocate(e.text, e.size);
+                if(e.result.locations) _location_allocator.deallocate(e.result.locations, e.result.end_index);
+                e = entry{};
+            }
+
+            // FNV-1a
+            static unsigned hash(const char * text, int size) {
+                unsigned h = 2166136261u;
+                for (int ix = 0; ix < size; ++ix) { h ^= (unsigned char)text[ix]; h *= 16777619u; }
+                return h;
+            }
+
+            static bool equal(const text_format & a, const text_format & b) {
+                return a.leading==b.leading && a.fontSize==b.fontSize && a.letterSpacing==b.letterSpacing &&
+                       a.wordWrap==b.wordWrap && a.horizontalAlign==b.horizontalAlign &&
+                       a.verticalAlign==b.verticalAlign && a.kerning==b.kerning && a.autoScale==b.autoScale;
+            }
+
+            static bool equal(const char * a, const char * b, int size) {
+                for (int ix = 0; ix < size; ++ix) if(a[ix]!=b[ix]) return false;
+                return true;
+            }
+
+        public:
+            explicit layout_cache(const Allocator & allocator=Allocator()) :
+                    _char_allocator(allocator), _location_allocator(allocator) {}
+            layout_cache(const layout_cache &) = delete;
+            layout_cache & operator=(const layout_cache &) = delete;
+            ~layout_cache() { clear(); }
+
+            void clear() {
+                for (unsigned ix = 0; ix < entries; ++ix) release(_entries[ix]);
+            }
+
+            /**
+             * layout a text, see bitmap_font::layout_text. a cached layout is returned without
+             * laying out the text, its locations belong to the cache and are valid until the
+             * next call. the chunks after the first chunk are laid out into the buffer.
+             *
+             * @param font the font
+             * @param text the text
+             * @param numChars number of chars of the text
+             * @param box_width width of the box
+             * @param box_height height of the box
+             * @param format the text format
+             * @param locations_buffer the buffer of locations
+             * @param capacity size of the buffer, -1 if it is big enough for any text
+             * @param previous the result of the previous chunk, null for the first chunk
+             *
+             * @return the layout of the chunk
+             */
+            template<class font_type>
+            text_layout_result layout(font_type & font, const char * text, int numChars,
+                                      int box_width, int box_height, const text_format & format,
+                                      char_location * locations_buffer, int capacity=-1,
+                                      const text_layout_result * previous=nullptr) {
+                if(previous || text==nullptr || numChars<=0)
+                    return font.layout_text(text, numChars, box_width, box_height, format,
+                                            locations_buffer, capacity, previous);
+                const unsigned h = hash(text, numChars);
+                entry & e = _entries[h & (entries-1)];
+                if(e.font==&font && e.hash==h && e.size==numChars && e.box_width==box_width &&
+                   e.box_height==box_height && equal(e.format, format) && equal(e.text, text, numChars))
+                    return e.result;
+                auto result = font.layout_text(text, numChars, box_width, box_height, format,
+                                               locations_buffer, capacity);
+                if(result.next_index>=0) return result;
+                release(e);
+                e.font=&font; e.hash=h; e.size=numChars;
+                e.box_width=box_width; e.box_height=box_height; e.format=format;
+                e.text = _char_allocator.allocate(numChars);
+                for (int ix = 0; ix < numChars; ++ix) e.text[ix]=text[ix];
+                e.result = result;
+                e.result.locations = nullptr;
+                if(result.end_index>0) {
+                    e.result.locations = _location_allocator.allocate(result.end_index);
+                    for (int ix = 0; ix < result.end_index; ++ix) e.result.locations[ix]=result.locations[ix];
+                }
+                return result;
+            }
+        };
+    }
+}
@@ -0,0 +1,188 @@
+/*========================================================================================
+ Copyright (2021), Tomer Shalev (tomer.shalev@gmail.com, https://github.com/HendrixString).
+ All Rights Reserved.
+ License is a custom open source semi-permissive license with the following guidelines:
+ 1. unless otherwise stated, derivative work and usage of this file is permitted and
+    should be credited to the project and the author of this project.
+ 2. Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+========================================================================================*/
+#pragma once
+
+#include "bitmap_font.h"
+#include "../math/int_math.h"
+#include "../traits.h"
+
+namespace microgl {
+    namespace text {
+
+        /**
+         * converts a regular bitmap font into a signed distance field font. the glyphs are
+         * packed in rows into the bitmap of the distance field font with a border of (spread)
+         * pixels, every pixel holds the distance to the edge of its glyph, which is 128 at the
+         * edge, bigger inside and saturates (spread) pixels away from it. distances are the
+         * euclidean distances of the centers of the pixels (8SSEDT), partially covered pixels
+         * are placed by their coverage. conversion is meant to be done offline, the distance
+         * field font is drawn at any size, see bitmap_font::sdf_spread.
+         *
+         * @tparam Allocator the allocator of the working memory of the conversion
+         */
+        template<class Allocator=microgl::traits::std_rebind_allocator<>>
+        class sdf_converter {
+            using int_allocator = typename Allocator::template rebind<int>::other;
+            static constexpr int unknown = 1<<12;
+
+            static int cell(int size, int spread) { return size>0 ? size + 2*spread : 0; }
+
+            // places the cells of the glyphs in rows, place(index, x, y) gets the top left of a cell
+            template<class font_type, class callback>
+            static int pack(const font_type & font, int spread, int atlas_width, const callback & place) {
+                int x=0, y=0, row=0;
+                for (int ix = 1; ix < font.charsCount(); ++ix) {
+                    const auto & c = font.gylphs[ix];
+                    const int w = cell(c.width, spread), h = cell(c.height, spread);
+                    if(w==0 || h==0) { place(ix, 0, 0); continue; }
+                    if(x+w>atlas_width && x>0) { x=0; y+=row; row=0; }
+                    place(ix, x, y);
+                    x+=w; row = h>row ? h : row;
+                }
+                return y+row;
+            }
+
+            static void compare(int * dx, int * dy, int w, int x, int y, int ox, int oy) {
+                const int p = y*w + x, n = (y+oy)*w + x+ox;
+                if(dx[n]>=unknown) return;
+                const int cx = dx[n]+ox, cy = dy[n]+oy;
+                if(dx[p]>=unknown || cx*cx+cy*cy < dx[p]*dx[p]+dy[p]*dy[p]) { dx[p]=cx; dy[p]=cy; }
+            }
+
+            // the offsets of the pixels to their nearest seed, seeds have a zero offset
+            static void sweep(int * dx, int * dy, int w, int h) {
+                for (int y = 0; y < h; ++y) {
+                    for (int x = 0; x < w; ++x) {
+                        if(x>0) compare(dx, dy, w, x, y, -1, 0);
+                        if(y>0) {
+                            compare(dx, dy, w, x, y, 0, -1);
+                            if(x>0) compare(dx, dy, w, x, y, -1, -1);
+                            if(x<w-1) compare(dx, dy, w, x, y, 1, -1);
+                        }
+                    }
+                    for (int x = w-2; x >= 0; --x) compare(dx, dy, w, x, y, 1, 0);
+                }
+                for (int y = h-1; y >= 0; --y) {
+                    for (int x = w-1; x >= 0; --x) {
+                        if(x<w-1) compare(dx, dy, w, x, y, 1, 0);
+                        if(y<h-1) {
+                            compare(dx, dy, w, x, y, 0, 1);
+                            if(x>0) compare(dx, dy, w, x, y, -1, 1);
+                            if(x<w-1) compare(dx, dy, w, x, y, 1, 1);
+                        }
+                    }
+                    for (int x = 1; x < w; ++x) compare(dx, dy, w, x, y, -1, 0);
+                }
+            }
+
+            // distance in 1/16 pixels from the center of a pixel to the edge, from its offset to
+            // the nearest pixel on the other side of the edge
+            static int distance(int dx, int dy) {
+                if(dx>=unknown) return unknown<<4;
+                return int(microgl::math::sqrt_32(unsigned(dx*dx+dy*dy)<<8)) - 8;
+            }
+
+            template<class font_type, class atlas_type>
+            static void convert_glyph(const font_type & source, const bitmap_glyph & c, atlas_type & atlas,
+                                      int left, int top, int spread, int * fields) {
+                using rgba = typename atlas_type::rgba;
+                const int w = cell(c.width, spread), h = cell(c.height, spread), size = w*h;
+                int * in_dx = fields, * in_dy = fields + size, * out_dx = fields + 2*size, * out_dy = fields + 3*size;
+                for (int y = 0; y < h; ++y) {
+                    for (int x = 0; x < w; ++x) {
+                        const int gx = x-spread, gy = y-spread, p = y*w + x;
+                        const bool glyph = gx>=0 && gy>=0 && gx<c.width && gy<c.height;
+                        const bool inside = glyph && source.coverage(c.x+gx, c.y+gy)>=128;
+                        in_dx[p] = in_dy[p] = inside ? 0 : unknown;
+                        out_dx[p] = out_dy[p] = inside ? unknown : 0;
+                    }
+                }
+                sweep(in_dx, in_dy, w, h);
+                sweep(out_dx, out_dy, w, h);
+                for (int y = 0; y < h; ++y) {
+                    for (int x = 0; x < w; ++x) {
+                        const int gx = x-spread, gy = y-spread, p = y*w + x;
+                        const bool glyph = gx>=0 && gy>=0 && gx<c.width && gy<c.height;
+                        const int coverage = glyph ? source.coverage(c.x+gx, c.y+gy) : 0;
+                        // positive outside, 1/16 pixels
+                        int d;
+                        if(coverage>0 && coverage<255) d = ((255 - 2*coverage)*8)/255;
+                        else d = coverage==0 ? distance(in_dx[p], in_dy[p]) : -distance(out_dx[p], out_dy[p]);
+                        int value = 128 - (d*8)/spread;
+                        value = value<0 ? 0 : (value>255 ? 255 : value);
+                        const microgl::channel_t r = value>>(8-rgba::r), a = value>>(8-rgba::a);
+                        atlas.writeColor(left+x, top+y, microgl::color_t{r, r, r, a});
+                    }
+                }
+            }
+
+        public:
+            /**
+             * the height of the bitmap of the distance field font of a font
+             *
+             * @param font the font
+             * @param spread the spread in pixels
+             * @param atlas_width the width of the bitmap of the distance field font
+             */
+            template<class font_type>
+            static int atlas_height(const font_type & font, int spread, int atlas_width) {
+                return pack(font, spread, atlas_width, [](int, int, int) {});
+            }
+
+            /**
+             * convert a font into a distance field font, whose bitmap was already created with a
+             * size of at least (atlas_width x atlas_height()). the metrics and the glyphs of the
+             * font are copied to the distance field font.
+             *
+             * @param source the regular font
+             * @param destination the distance field font with an empty set of glyphs
+             * @param spread the spread in pixels, distances saturate at it
+             * @param allocator the allocator of the working memory
+             *
+             * @return false if the glyphs do not fit the bitmap of the distance field font
+             */
+            template<class font_type, class sdf_font_type>
+            static bool convert(const font_type & source, sdf_font_type & destination, int spread,
+                                const Allocator & allocator=Allocator()) {
+                auto & atlas = *destination.bitmap;
+                if(spread<1 || pack(source, spread, atlas.width(), [](int, int, int) {})>atlas.height())
+                    return false;
+                int max_size = 0;
+                for (int ix = 1; ix < source.charsCount(); ++ix) {
+                    const auto & c = source.gylphs[ix];
+                    const int size = cell(c.width, spread)*cell(c.height, spread);
+                    max_size = size>max_size ? size : max_size;
+                }
+                for (unsigned ix = 0; ix < sizeof(destination.name); ++ix) destination.name[ix]=source.name[ix];
+                destination.nativeSize=source.nativeSize; destination.lineHeight=source.lineHeight;
+                destination.baseline=source.baseline; destination.offsetX=source.offsetX;
+                destination.offsetY=source.offsetY; destination.padding=source.padding;
+                destination.glyphs_count=source.glyphs_count;
+                destination.width=atlas.width(); destination.height=atlas.height();
+                destination.sdf_spread=spread;
+                for (int y = 0; y < atlas.height(); ++y)
+                    for (int x = 0; x < atlas.width(); ++x)
+                        atlas.writeColor(x, y, microgl::color_t{0, 0, 0, 0});
+                int_allocator int_alloc(allocator);
+                int * fields = max_size ? int_alloc.allocate(4*max_size) : nullptr;
+                pack(source, spread, atlas.width(), [&](int index, int x, int y) {
+                    const auto & c = source.gylphs[index];
+                    const bool empty = cell(c.width, spread)==0 || cell(c.height, spread)==0;
+                    if(!empty) convert_glyph(source, c, atlas, x, y, spread, fields);
+                    destination.addChar(c.id, x+spread, y+spread, c.width, c.height,
+                                        c.xOffset, c.yOffset, c.xAdvance);
+                });
+                if(fields) int_alloc.deallocate(fields, 4*max_size);
+                return true;
+            }
+        };
+    }
+}
@@ -0,0 +1,510 @@
+/*========================================================================================
+ Copyright (2021), Tomer Shalev (tomer.shalev@gmail.com, https://github.com/HendrixString).
+ All Rights Reserved.
+ License is a custom open source semi-permissive license with the following guidelines:
+ 1. unless otherwise stated, derivative work and usage of this file is permitted and
+    should be credited to the project and the author of this project.
+ 2. Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+========================================================================================*/
+#pragma once
+
+#include "../canvas.h"
+
+namespace microgl {
+    namespace tiles {
+
+        /**
+         * Deferred (tile binned) rendering.
+         *
+         * A display list records draw calls for a full frame instead of rasterizing them
+         * immediately. Every recorded command carries a conservative bounding box in frame
+         * coordinates. When rendering, the commands are binned into tiles, whose size is the
+         * size of the bitmap of the canvas that is used for rendering, and each tile replays
+         * only the commands that touch it, through the block rendering mechanism of the
+         * canvas (updateCanvasWindow and index correction). This way, a small canvas (32x32 or
+         * 64x64 pixels) that fits in cache can render a big frame, and every tile does only
+         * the work that is relevant for it.
+         *
+         * Notes:
+         * 1. Commands are replayed in the order they were recorded, per tile, so compositing
+         *    order is the same as in immediate mode.
+         * 2. Commands hold references to the samplers/fonts/paths and pointers to the vertex,
+         *    index and text arrays given to them, these have to outlive the call to render().
+         *    The bounding boxes of paths are taken when recording, so paths should not change
+         *    until then.
+         * 3. Tile pixels are not cleared between tiles, record clear() as the first command
+         *    or draw an opaque background, otherwise the previous tile leaks into the next one.
+         *
+         * Example:
+         *
+         *  canvas<Bitmap> canvas(64, 64);
+         *  display_list<canvas<Bitmap>> list(W, H);
+         *  list.clear({255,255,255,255});
+         *  list.drawRect(sampler, 10, 10, 400, 400);
+         *  list.render(canvas, [&](canvas<Bitmap> & c, const rect & tile) {
+         *      // copy c.pixels() into the frame buffer at tile.left, tile.top
+         *  });
+         *
+         * @tparam canvas_type the canvas type, that will replay the commands
+         * @tparam Allocator allocator for commands and bins
+         */
+        template<class canvas_type, class Allocator=microgl::traits::std_rebind_allocator<>>
+        class display_list {
+        public:
+            using rect = microgl::rect_t<int>;
+            using index = unsigned int;
+            using opacity_t = typename canvas_type::opacity_t;
+            using allocator_type = Allocator;
+
+        private:
+            // commands are type erased with plain function pointers, the library does not use virtual methods
+            struct command_base {
+                using execute_function = void (*)(const command_base *, canvas_type &);
+                using destroy_function = void (*)(command_base *, const Allocator &);
+                rect bbox;
+                execute_function execute;
+                destroy_function destroy;
+            };
+
+            template<class Command>
+            struct command : public command_base {
+                Command cmd;
+                command(const rect & bbox, const Command & cmd) : command_base{bbox, &execute_, &destroy_},
+                                                                  cmd(cmd) {}
+                static void execute_(const command_base * self, canvas_type & canvas) {
+                    static_cast<const command *>(self)->cmd(canvas);
+                }
+                static void destroy_(command_base * self, const Allocator & allocator) {
+                    using rebind = typename Allocator::template rebind<command>::other;
+                    rebind alloc(allocator);
+                    auto * me = static_cast<command *>(self);
+                    me->~command();
+                    alloc.deallocate(me, 1);
+                }
+            };
+
+            using commands_array = dynamic_array<command_base *, Allocator>;
+            using indices_array = dynamic_array<index, Allocator>;
+
+            commands_array _commands;
+            // tile bins are kept in compressed rows layout, the commands of tile i are
+            // _bins[_bins_offsets[i] .. _bins_offsets[i+1]-1]
+            indices_array _bins_offsets;
+            indices_array _bins;
+            Allocator _allocator;
+            rect _frame;
+            int _bins_tile_width, _bins_tile_height;
+
+            template<typename number>
+            static int floor_int(const number & val) { return microgl::math::to_fixed(val, 0) - 1; }
+            template<typename number>
+            static int ceil_int(const number & val) { return microgl::math::to_fixed(val, 0) + 2; }
+
+            void invalidate_bins() { _bins_tile_width=_bins_tile_height=0; }
+
+            void bin(int tile_width, int tile_height) {
+                if(tile_width==_bins_tile_width && tile_height==_bins_tile_height) return;
+                const int tiles_h = tilesHorizontal(tile_width);
+                const int tiles_v = tilesVertical(tile_height);
+                const index tiles_count = tiles_h * tiles_v;
+                _bins_offsets.clear();
+                _bins_offsets.resize(tiles_count + 1, 0);
+                // first pass, count commands per tile, second pass, fill the bins
+                for (int pass = 0; pass < 2; ++pass) {
+                    if(pass==1) {
+                        index sum = 0;
+                        for (index ix = 0; ix <= tiles_count; ++ix) {
+                            const index count = _bins_offsets[ix];
+                            _bins_offsets[ix] = sum; sum += count;
+                        }
+                        _bins.clear();
+                        _bins.resize(sum, 0);
+                    }
+                    for (index ix = 0; ix < _commands.size(); ++ix) {
+                        const rect bbox = _commands[ix]->bbox.intersect(_frame);
+                        if(bbox.empty()) continue;
+                        const int tx0 = (bbox.left-_frame.left) / tile_width;
+                        const int ty0 = (bbox.top-_frame.top) / tile_height;
+                        const int tx1 = (bbox.right-1-_frame.left) / tile_width;
+                        const int ty1 = (bbox.bottom-1-_frame.top) / tile_height;
+                        for (int ty = ty0; ty <= ty1; ++ty) {
+                            for (int tx = tx0; tx <= tx1; ++tx) {
+                                const index tile = ty*tiles_h + tx;
+                                if(pass==0) _bins_offsets[tile]+=1;
+                                else _bins[_bins_offsets[tile]++] = ix;
+                            }
+                        }
+                    }
+                }
+                // second pass advanced every offset by one tile, shift them back
+                for (index ix = tiles_count; ix > 0; --ix)
+                    _bins_offsets[ix] = _bins_offsets[ix-1];
+                _bins_offsets[0] = 0;
+                _bins_tile_width=tile_width; _bins_tile_height=tile_height;
+            }
+
+            // conservative bounding box of the box (min, max) in local space, outset and then transformed
+            template<typename number>
+            static rect transformed_bbox(const matrix_3x3<number> & transform,
+                                         vertex2<number> min, vertex2<number> max, const number & outset) {
+                min.x-=outset; min.y-=outset; max.x+=outset; max.y+=outset;
+                const vertex2<number> corners[4] = {transform*min, transform*vertex2<number>{max.x, min.y},
+                                                    transform*max, transform*vertex2<number>{min.x, max.y}};
+                vertex2<number> lo=corners[0], hi=corners[0];
+                for (const auto & c : corners) {
+                    if(c.x<lo.x) lo.x=c.x;
+                    if(c.y<lo.y) lo.y=c.y;
+                    if(c.x>hi.x) hi.x=c.x;
+                    if(c.y>hi.y) hi.y=c.y;
+                }
+                return {floor_int(lo.x), floor_int(lo.y), ceil_int(hi.x), ceil_int(hi.y)};
+            }
+
+            // conservative bounding box of (count) points, that are transformed, point(k) is the k-th point
+            template<typename number, class point_function>
+            static rect points_bbox(const matrix_3x3<number> & transform, index count,
+                                    const point_function & point, const number & outset=number(0)) {
+                if(count==0) return {0, 0, 0, 0};
+                vertex2<number> min=point(0), max=min;
+                for (index ix = 1; ix < count; ++ix) {
+                    const vertex2<number> & pt=point(ix);
+                    if(pt.x<min.x) min.x=pt.x;
+                    if(pt.y<min.y) min.y=pt.y;
+                    if(pt.x>max.x) max.x=pt.x;
+                    if(pt.y>max.y) max.y=pt.y;
+                }
+                return transformed_bbox(transform, min, max, outset);
+            }
+
+            // conservative bounding box of the vertices of the sub paths of a path
+            template<class path_type, typename number>
+            static rect path_bbox(const matrix_3x3<number> & transform, path_type & path, const number & outset) {
+                bool first=true;
+                vertex2<number> min, max;
+                for (int ix = 0; ix < path.subpathsCount(); ++ix) {
+                    const auto sub_path = path.getSubPath(ix);
+                    for (int kx = 0; kx < int(sub_path.size()); ++kx) {
+                        const auto & pt = sub_path[kx];
+                        if(first) { min=max=pt; first=false; continue; }
+                        if(pt.x<min.x) min.x=pt.x;
+                        if(pt.y<min.y) min.y=pt.y;
+                        if(pt.x>max.x) max.x=pt.x;
+                        if(pt.y>max.y) max.y=pt.y;
+                    }
+                }
+                if(first) return {0, 0, 0, 0};
+                return transformed_bbox(transform, min, max, outset);
+            }
+
+        public:
+            /**
+             * construct a display list for a frame
+             * @param width the frame width
+             * @param height the frame height
+             * @param allocator allocator for commands and bins
+             */
+            display_list(int width, int height, const Allocator & allocator=Allocator()) :
+                    _commands(allocator), _bins_offsets(allocator), _bins(allocator),
+                    _allocator(allocator), _frame{0, 0, width, height},
+                    _bins_tile_width(0), _bins_tile_height(0) {}
+            display_list(const display_list &) = delete;
+            display_list & operator=(const display_list &) = delete;
+            ~display_list() { reset(); }
+
+            /**
+             * remove all of the recorded commands, memory of the bins is kept for the next frame
+             */
+            void reset() {
+                for (index ix = 0; ix < _commands.size(); ++ix)
+                    _commands[ix]->destroy(_commands[ix], _allocator);
+                _commands.clear();
+                invalidate_bins();
+            }
+
+            // the frame rectangle
+            const rect & frame() const { return _frame; }
+            // number of recorded commands
+            index size() const { return _commands.size(); }
+            // number of tiles for a given tile size
+            int tilesHorizontal(int tile_width) const { return 1+((_frame.width()-1)/tile_width); }
+            int tilesVertical(int tile_height) const { return 1+((_frame.height()-1)/tile_height); }
+
+            /**
+             * record a general command
+             *
+             * @tparam Command a callable of the form void(canvas_type &)
+             * @param bbox conservative bounding box of the pixels that the command touches
+             * @param cmd the command, it is copied into the list
+             */
+            template<class Command>
+            void record(const rect & bbox, const Command & cmd) {
+                using rebind = typename Allocator::template rebind<command<Command>>::other;
+                rebind alloc(_allocator);
+                auto * mem = alloc.allocate(1);
+                _commands.push_back(new (mem) command<Command>(bbox, cmd));
+                invalidate_bins();
+            }
+
+            /**
+             * record a general command, that touches the whole frame
+             */
+            template<class Command>
+            void record(const Command & cmd) { record(_frame, cmd); }
+
+            /**
+             * record a clear of the whole frame
+             */
+            void clear(const color_t & color) {
+                record([color](canvas_type & canvas) { canvas.clear(color); });
+            }
+
+            template <typename BlendMode=blendmode::Normal,
+                    typename PorterDuff=porterduff::FastSourceOverOnOpaque, bool antialias=false,
+                    typename number1, typename number2=number1, typename Sampler>
+            void drawRect(const Sampler &sampler,
+                          const number1 & left, const number1 & top,
+                          const number1 & right, const number1 & bottom,
+                          opacity_t opacity = 255,
+                          const number2 & u0= number2(0), const number2 & v0= number2(1),
+                          const number2 & u1= number2(1), const number2 & v1= number2(0)) {
+                record({floor_int(left), floor_int(top), ceil_int(right), ceil_int(bottom)},
+                       [&sampler, left, top, right, bottom, opacity, u0, v0, u1, v1](canvas_type & canvas) {
+                    canvas.template drawRect<BlendMode, PorterDuff, antialias, number1, number2>(
+                            sampler, left, top, right, bottom, opacity, u0, v0, u1, v1);
+                });
+            }
+
+            template<typename BlendMode=blendmode::Normal,
+                    typename PorterDuff=porterduff::FastSourceOverOnOpaque, bool antialias=false, typename number1,
+                    typename number2=number1, typename Sampler1, typename Sampler2>
+            void drawRoundedRect(const Sampler1 & sampler_fill,
+                                 const Sampler2 & sampler_stroke,
+                                 const number1 &left, const number1 &top,
+                                 const number1 &right, const number1 &bottom,
+                                 const number1 &radius, const number1 &stroke_size,
+                                 opacity_t opacity= 255,
+                                 const number2 &u0= number2(0), const number2 &v0= number2(1),
+                                 const number2 &u1= number2(1), const number2 &v1= number2(0)) {
+                record({floor_int(left), floor_int(top), ceil_int(right), ceil_int(bottom)},
+                       [&sampler_fill, &sampler_stroke, left, top, right, bottom, radius, stroke_size,
+                        opacity, u0, v0, u1, v1](canvas_type & canvas) {
+                    canvas.template drawRoundedRect<BlendMode, PorterDuff, antialias, number1, number2>(
+                            sampler_fill, sampler_stroke, left, top, right, bottom, radius, stroke_size,
+                            opacity, u0, v0, u1, v1);
+                });
+            }
+
+            template<typename BlendMode=blendmode::Normal,
+                    typename PorterDuff=porterduff::FastSourceOverOnOpaque, bool antialias=false,
+                    typename number1, typename number2=number1, typename Sampler1, typename Sampler2>
+            void drawCircle(const Sampler1 & sampler_fill,
+                            const Sampler2 & sampler_stroke,
+                            const number1 &centerX, const number1 &centerY,
+                            const number1 &radius, const number1 &stroke_size, opacity_t opacity=255,
+                            const number2 &u0=number2(0), const number2 &v0=number2(1),
+                            const number2 &u1=number2(1), const number2 &v1=number2(0)) {
+                drawRoundedRect<BlendMode, PorterDuff, antialias, number1, number2>(
+                        sampler_fill, sampler_stroke, centerX - radius, centerY - radius,
+                        centerX + radius, centerY + radius, radius, stroke_size, opacity,
+                        u0, v0, u1, v1);
+            }
+
+            template <typename BlendMode=blendmode::Normal,
+                    typename PorterDuff=porterduff::FastSourceOverOnOpaque,
+                    bool antialias=false, typename number1=float, typename number2=number1, typename Sampler>
+            void drawTriangle(const Sampler &sampler,
+                              const number1 &v0_x, const number1 &v0_y, const number2 &u0, const number2 &v0,
+                              const number1 &v1_x, const number1 &v1_y, const number2 &u1, const number2 &v1,
+                              const number1 &v2_x, const number1 &v2_y, const number2 &u2, const number2 &v2,
+                              opacity_t opacity = 255) {
+                using functions::min;
+                using functions::max;
+                record({floor_int(min(v0_x, v1_x, v2_x)), floor_int(min(v0_y, v1_y, v2_y)),
+                        ceil_int(max(v0_x, v1_x, v2_x)), ceil_int(max(v0_y, v1_y, v2_y))},
+                       [&sampler, v0_x, v0_y, u0, v0, v1_x, v1_y, u1, v1, v2_x, v2_y, u2, v2,
+                        opacity](canvas_type & canvas) {
+                    canvas.template drawTriangle<BlendMode, PorterDuff, antialias, number1, number2>(
+                            sampler, v0_x, v0_y, u0, v0, v1_x, v1_y, u1, v1, v2_x, v2_y, u2, v2, opacity);
+                });
+            }
+
+            template<typename BlendMode=blendmode::Normal, typename PorterDuff=porterduff::FastSourceOverOnOpaque,
+                    bool antialias=false, typename number1=float, typename number2=float, typename Sampler,
+                    class triangles_allocator=microgl::traits::std_rebind_allocator<>>
+            void drawTriangles(const Sampler & sampler,
+                               const matrix_3x3<number1> &transform,
+                               const vertex2<number1> *vertices= nullptr,
+                               const vertex2<number2> *uvs=nullptr,
+                               const index *indices= nullptr,
+                               const microtess::triangles::boundary_info * boundary_buffer= nullptr,
+                               index size=0,
+                               microtess::triangles::indices type=microtess::triangles::indices::TRIANGLES,
+                               opacity_t opacity=255,
+                               const number2 &u0=number2(0), const number2 &v0=number2(1),
+                               const number2 &u1=number2(1), const number2 &v1=number2(0),
+                               const triangles_allocator & allocator=triangles_allocator()) {
+                if(vertices==nullptr || size<3) return;
+                record(points_bbox(transform, size, [&](index k) -> const vertex2<number1> & {
+                           return vertices[indices ? indices[k] : k]; }),
+                       [&sampler, transform, vertices, uvs, indices, boundary_buffer, size, type, opacity,
+                        u0, v0, u1, v1, allocator](canvas_type & canvas) {
+                    canvas.template drawTriangles<BlendMode, PorterDuff, antialias, number1, number2>(
+                            sampler, transform, vertices, uvs, indices, boundary_buffer, size, type, opacity,
+                            u0, v0, u1, v1, allocator);
+                });
+            }
+
+            template <microtess::polygons::hints hint=microtess::polygons::hints::SIMPLE,
+                    typename BlendMode=blendmode::Normal,
+                    typename PorterDuff=porterduff::FastSourceOverOnOpaque,
+                    bool antialias=false, bool debug=false,
+                    typename number1=float, typename number2=number1, typename Sampler,
+                    class tessellation_allocator=microgl::traits::std_rebind_allocator<>>
+            void drawPolygon(const Sampler &sampler,
+                             const matrix_3x3<number1> &transform,
+                             const vertex2<number1> * points,
+                             index size, opacity_t opacity=255,
+                             number2 u0=number2(0), number2 v0=number2(1),
+                             number2 u1=number2(1), number2 v1=number2(0),
+                             const tessellation_allocator & allocator=tessellation_allocator()) {
+                record(points_bbox(transform, size, [&](index k) -> const vertex2<number1> & { return points[k]; }),
+                       [&sampler, transform, points, size, opacity, u0, v0, u1, v1, allocator](canvas_type & canvas) {
+                    canvas.template drawPolygon<hint, BlendMode, PorterDuff, antialias, debug, number1, number2>(
+                            sampler, transform, points, size, opacity, u0, v0, u1, v1, allocator);
+                });
+            }
+
+            template<typename BlendMode=blendmode::Normal, typename PorterDuff=porterduff::FastSourceOverOnOpaque,
+                    bool antialias=false, bool debug=false,
+                    typename number1=float, typename number2=float,
+                    typename Sampler, template<typename...> class path_container_template,
+                    class tessellation_allocator=microgl::traits::std_rebind_allocator<>>
+            void drawPathFill(const Sampler &sampler,
+                              const matrix_3x3<number1> &transform,
+                              microtess::path<number1, path_container_template, tessellation_allocator> &path,
+                              const microtess::fill_rule &rule=microtess::fill_rule::non_zero,
+                              const microtess::tess_quality &quality=microtess::tess_quality::better,
+                              opacity_t opacity=255,
+                              number2 u0=number2(0), number2 v0=number2(1),
+                              number2 u1=number2(1), number2 v1=number2(0),
+                              typename canvas_type::fill_engine engine=canvas_type::fill_engine::tessellation) {
+                record(path_bbox(transform, path, number1(0)),
+                       [&sampler, transform, &path, rule, quality, opacity, u0, v0, u1, v1,
+                        engine](canvas_type & canvas) {
+                    canvas.template drawPathFill<BlendMode, PorterDuff, antialias, debug, number1, number2>(
+                            sampler, transform, path, rule, quality, opacity, u0, v0, u1, v1, engine);
+                });
+            }
+
+            /**
+             * record a path stroke, the bounding box of the path is outset by the stroke
+             * width times the miter limit, which covers joins and caps
+             */
+            template<typename BlendMode=blendmode::Normal, typename PorterDuff=porterduff::FastSourceOverOnOpaque,
+                    bool antialias=false, bool debug=false,
+                    typename number1=float, typename number2=float,
+                    typename Sampler, class Iterable, template<typename...> class path_container_template,
+                    class tessellation_allocator=microgl::traits::std_rebind_allocator<>>
+            void drawPathStroke(const Sampler &sampler,
+                                const matrix_3x3<number1> &transform,
+                                microtess::path<number1, path_container_template, tessellation_allocator> &path,
+                                const number1 &stroke_width=number1(1),
+                                const microtess::stroke_cap &cap=microtess::stroke_cap::butt,
+                                const microtess::stroke_line_join &line_join=microtess::stroke_line_join::bevel,
+                                int miter_limit=4,
+                                const Iterable & stroke_dash_array={},
+                                int stroke_dash_offset=0, opacity_t opacity=255,
+                                number2 u0=number2(0), number2 v0=number2(1),
+                                number2 u1=number2(1), number2 v1=number2(0)) {
+                record(path_bbox(transform, path, stroke_width*number1(miter_limit>1 ? miter_limit : 1)),
+                       [&sampler, transform, &path, stroke_width, cap, line_join, miter_limit, stroke_dash_array,
+                        stroke_dash_offset, opacity, u0, v0, u1, v1](canvas_type & canvas) {
+                    canvas.template drawPathStroke<BlendMode, PorterDuff, antialias, debug, number1, number2>(
+                            sampler, transform, path, stroke_width, cap, line_join, miter_limit, stroke_dash_array,
+                            stroke_dash_offset, opacity, u0, v0, u1, v1);
+                });
+            }
+
+            /**
+             * record a text, the text is drawn inside its box, which is its bounding box
+             */
+            template<bool tint=true, bool smooth=false, bool frame=false, typename bitmap_font_type>
+            void drawText(const char *text, microgl::text::bitmap_font<bitmap_font_type> &font, const color_t & color,
+                          const microgl::text::text_format & format,
+                          int left, int top, int right, int bottom, opacity_t opacity=255) {
+                record({left, top, right, bottom},
+                       [text, &font, color, format, left, top, right, bottom, opacity](canvas_type & canvas) {
+                    microgl::text::text_format text_format = format;
+                    canvas.template drawText<tint, smooth, frame>(text, font, color, text_format,
+                                                                   left, top, right, bottom, opacity);
+                });
+            }
+
+            /**
+             * replay the display list tile by tile.
+             *
+             * the tile size is the size of the bitmap of the canvas. for every tile with
+             * at least one command, the canvas window is moved to the tile, the commands of
+             * the tile are replayed and then the callback is invoked, so the tile pixels can
+             * be copied to the frame buffer or display. tiles without commands are skipped.
+             * a clip rect of the canvas is in frame coordinates and clips every tile, the
+             * default clip of a canvas, which is the rect of its bitmap, clips nothing.
+             *
+             * @tparam on_tile_callback callable of the form void(canvas_type &, const rect &)
+             * @param canvas the canvas
+             * @param on_tile the callback, receives the canvas and the tile rectangle in
+             * frame coordinates, clipped to the frame
+             */
+            template<class on_tile_callback>
+            void render(canvas_type & canvas, const on_tile_callback & on_tile) {
+                const index tiles_count = prepare(canvas.bitmapCanvas().width(),
+                                                  canvas.bitmapCanvas().height());
+                for (index tile = 0; tile < tiles_count; ++tile)
+                    if(tileCommands(tile)) renderTile(canvas, tile, on_tile);
+            }
+
+            /**
+             * bin the commands for a tile size, this is done lazily by render(), and is exposed
+             * for renderers that schedule tiles by themselves.
+             *
+             * @return the number of tiles, tiles are ordered row by row
+             */
+            index prepare(int tile_width, int tile_height) {
+                bin(tile_width, tile_height);
+                return tilesHorizontal(tile_width) * tilesVertical(tile_height);
+            }
+
+            // number of commands of a tile, valid after prepare()
+            index tileCommands(index tile) const { return _bins_offsets[tile+1] - _bins_offsets[tile]; }
+
+            /**
+             * replay the commands of a single tile, valid after prepare() with the size of
+             * the bitmap of the canvas. this method does not modify the display list, so
+             * different tiles can be replayed concurrently with different canvases.
+             */
+            template<class on_tile_callback>
+            void renderTile(canvas_type & canvas, index tile, const on_tile_callback & on_tile) const {
+                const int tiles_h = tilesHorizontal(_bins_tile_width);
+                const int left = _frame.left + int(tile % tiles_h)*_bins_tile_width;
+                const int top = _frame.top + int(tile / tiles_h)*_bins_tile_height;
+                // the clip of the canvas is in frame coordinates, the default clip of a canvas,
+                // that is its bitmap, is not a clip of the frame
+                const rect clip = canvas.clipRect();
+                const bool bitmap_clip = clip.left==0 && clip.top==0 && clip.right==canvas.bitmapCanvas().width()
+                                         && clip.bottom==canvas.bitmapCanvas().height();
+                const rect tile_clip = bitmap_clip ? _frame : clip.intersect(_frame);
+                canvas.updateClipRect(tile_clip.left, tile_clip.top, tile_clip.right, tile_clip.bottom);
+                canvas.updateCanvasWindow(left, top);
+                for (index ix = _bins_offsets[tile]; ix < _bins_offsets[tile+1]; ++ix) {
+                    const command_base * cmd = _commands[_bins[ix]];
+                    cmd->execute(cmd, canvas);
+                }
+                canvas.updateClipRect(clip.left, clip.top, clip.right, clip.bottom);
+                on_tile(canvas, canvas.canvasWindowRect().intersect(_frame));
+            }
+        };
+
+    }
+}
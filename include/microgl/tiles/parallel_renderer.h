@@ -0,0 +1,249 @@
+/*========================================================================================
+ Copyright (2021), Tomer Shalev (tomer.shalev@gmail.com, https://github.com/HendrixString).
+ All Rights Reserved.
+ License is a custom open source semi-permissive license with the following guidelines:
+ 1. unless otherwise stated, derivative work and usage of this file is permitted and
+    should be credited to the project and the author of this project.
+ 2. Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+========================================================================================*/
+#pragma once
+
+#include "display_list.h"
+
+// threads are used only if the tool-chain supports them, define MICROGL_NO_THREADS
+// to force a single threaded renderer on a hosted platform
+#if defined(__STDCPP_THREADS__) && !defined(MICROGL_NO_THREADS)
+#define MICROGL_THREADS
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#endif
+
+namespace microgl {
+    namespace tiles {
+
+        /**
+         * Parallel tile renderer.
+         *
+         * Renders a display_list with a pool of worker threads, every worker owns a canvas of
+         * the tile size, so workers never share pixels. Non empty tiles are split into contiguous
+         * ranges, one range per worker, a worker consumes its own range from the front and when
+         * it is done it steals tiles from the back of the ranges of other workers, this keeps
+         * neighbouring tiles on the same worker and balances frames, where the work is
+         * concentrated in a small part of the frame. The calling thread participates as the
+         * first worker.
+         *
+         * Notes:
+         * 1. The on_tile callback is invoked concurrently from different threads with
+         *    different tiles, it is safe to copy the tile into disjoint parts of a frame buffer.
+         * 2. Samplers, shaders and fonts used by commands are shared between workers and
+         *    are used through const references, do not mutate them while rendering.
+         * 3. If threads are not available (embedded tool-chains) or MICROGL_NO_THREADS is
+         *    defined, nothing of the threading library is included and the renderer runs
+         *    every tile on the calling thread.
+         *
+         * @tparam canvas_type the canvas type of the workers
+         * @tparam Allocator allocator for the workers and queues
+         */
+        template<class canvas_type, class Allocator=microgl::traits::std_rebind_allocator<>>
+        class parallel_renderer {
+        public:
+            using index = unsigned int;
+            using rect = microgl::rect_t<int>;
+            using allocator_type = Allocator;
+
+        private:
+            using tile_job = void (*)(const void *, canvas_type &, index);
+
+            struct worker_queue {
+                index begin=0, end=0;
+#ifdef MICROGL_THREADS
+                std::mutex lock;
+#endif
+            };
+
+            template<class T>
+            T * allocate_and_construct(unsigned count) {
+                typename Allocator::template rebind<T>::other alloc(_allocator);
+                T * mem = alloc.allocate(count);
+                for (unsigned ix = 0; ix < count; ++ix) new (mem+ix) T();
+                return mem;
+            }
+            template<class T>
+            void destruct_and_deallocate(T * mem, unsigned count) {
+                typename Allocator::template rebind<T>::other alloc(_allocator);
+                for (unsigned ix = 0; ix < count; ++ix) (mem+ix)->~T();
+                alloc.deallocate(mem, count);
+            }
+
+            Allocator _allocator;
+            unsigned _workers;
+            canvas_type * _canvases;
+            worker_queue * _queues;
+            dynamic_array<index, Allocator> _tiles;
+            // current frame
+            tile_job _job;
+            const void * _job_context;
+#ifdef MICROGL_THREADS
+            std::thread * _threads;
+            std::mutex _mutex;
+            std::condition_variable _wake, _done;
+            unsigned _generation, _working;
+            bool _quit;
+
+            void worker_main(unsigned id) {
+                unsigned seen_generation = 0;
+                while(true) {
+                    {
+                        std::unique_lock<std::mutex> guard(_mutex);
+                        _wake.wait(guard, [&]() { return _quit || _generation!=seen_generation; });
+                        if(_quit) return;
+                        seen_generation = _generation;
+                    }
+                    work(id);
+                    {
+                        std::lock_guard<std::mutex> guard(_mutex);
+                        if(--_working==0) _done.notify_one();
+                    }
+                }
+            }
+#endif
+
+            bool pop(unsigned id, index & tile) {
+                worker_queue & queue = _queues[id];
+#ifdef MICROGL_THREADS
+                std::lock_guard<std::mutex> guard(queue.lock);
+#endif
+                if(queue.begin==queue.end) return false;
+                tile = _tiles[queue.begin++];
+                return true;
+            }
+
+            bool steal(unsigned id, index & tile) {
+                for (unsigned ix = 1; ix < _workers; ++ix) {
+                    worker_queue & victim = _queues[(id + ix) % _workers];
+#ifdef MICROGL_THREADS
+                    std::lock_guard<std::mutex> guard(victim.lock);
+#endif
+                    if(victim.begin==victim.end) continue;
+                    tile = _tiles[--victim.end];
+                    return true;
+                }
+                return false;
+            }
+
+            void work(unsigned id) {
+                index tile;
+                while(pop(id, tile) || steal(id, tile))
+                    _job(_job_context, _canvases[id], tile);
+            }
+
+            template<class list_type, class on_tile_callback>
+            struct job_context {
+                const list_type * list;
+                const on_tile_callback * on_tile;
+                static void run(const void * context, canvas_type & canvas, index tile) {
+                    const auto * ctx = static_cast<const job_context *>(context);
+                    ctx->list->renderTile(canvas, tile, *(ctx->on_tile));
+                }
+            };
+
+        public:
+            /**
+             * @param tile_width width of tiles, every worker allocates a bitmap of the tile size
+             * @param tile_height height of tiles
+             * @param workers number of workers including the calling thread, 0 means the
+             * number of hardware threads
+             * @param allocator allocator for workers and queues
+             */
+            parallel_renderer(int tile_width, int tile_height, unsigned workers=0,
+                              const Allocator & allocator=Allocator()) :
+                              _allocator(allocator), _workers(workers), _canvases(nullptr),
+                              _queues(nullptr), _tiles(allocator), _job(nullptr), _job_context(nullptr) {
+#ifdef MICROGL_THREADS
+                if(_workers==0) _workers = std::thread::hardware_concurrency();
+                if(_workers==0) _workers = 1;
+#else
+                _workers = 1;
+#endif
+                typename Allocator::template rebind<canvas_type>::other alloc(_allocator);
+                _canvases = alloc.allocate(_workers);
+                for (unsigned ix = 0; ix < _workers; ++ix)
+                    new (_canvases+ix) canvas_type(tile_width, tile_height);
+                _queues = allocate_and_construct<worker_queue>(_workers);
+#ifdef MICROGL_THREADS
+                _generation=0; _working=0; _quit=false;
+                _threads = allocate_and_construct<std::thread>(_workers);
+                for (unsigned ix = 1; ix < _workers; ++ix)
+                    _threads[ix] = std::thread(&parallel_renderer::worker_main, this, ix);
+#endif
+            }
+            parallel_renderer(const parallel_renderer &) = delete;
+            parallel_renderer & operator=(const parallel_renderer &) = delete;
+
+            ~parallel_renderer() {
+#ifdef MICROGL_THREADS
+                {
+                    std::lock_guard<std::mutex> guard(_mutex);
+                    _quit = true;
+                }
+                _wake.notify_all();
+                for (unsigned ix = 1; ix < _workers; ++ix) _threads[ix].join();
+                destruct_and_deallocate(_threads, _workers);
+#endif
+                destruct_and_deallocate(_queues, _workers);
+                destruct_and_deallocate(_canvases, _workers);
+            }
+
+            // number of workers, including the calling thread
+            unsigned workers() const { return _workers; }
+            // the canvas of a worker, use it to set rendering options
+            canvas_type & workerCanvas(unsigned worker) { return _canvases[worker]; }
+
+            /**
+             * render a display list, returns after all tiles were rendered.
+             *
+             * @tparam on_tile_callback callable of the form void(canvas_type &, const rect &)
+             * @param list the display list
+             * @param on_tile the tile callback, invoked concurrently from the workers
+             */
+            template<class list_allocator, class on_tile_callback>
+            void render(display_list<canvas_type, list_allocator> & list, const on_tile_callback & on_tile) {
+                const index tiles_count = list.prepare(_canvases[0].bitmapCanvas().width(),
+                                                       _canvases[0].bitmapCanvas().height());
+                _tiles.clear();
+                for (index tile = 0; tile < tiles_count; ++tile)
+                    if(list.tileCommands(tile)) _tiles.push_back(tile);
+                // contiguous ranges, so every worker starts with neighbouring tiles
+                const index count = _tiles.size();
+                for (unsigned ix = 0; ix < _workers; ++ix) {
+                    _queues[ix].begin = (count * ix) / _workers;
+                    _queues[ix].end = (count * (ix + 1)) / _workers;
+                }
+                using context_type = job_context<display_list<canvas_type, list_allocator>, on_tile_callback>;
+                context_type context{&list, &on_tile};
+                _job = &context_type::run;
+                _job_context = &context;
+#ifdef MICROGL_THREADS
+                if(_workers > 1 && count > 1) {
+                    {
+                        std::lock_guard<std::mutex> guard(_mutex);
+                        _working = _workers - 1;
+                        _generation += 1;
+                    }
+                    _wake.notify_all();
+                    work(0);
+                    std::unique_lock<std::mutex> guard(_mutex);
+                    _done.wait(guard, [&]() { return _working==0; });
+                    return;
+                }
+#endif
+                // single worker, steal everything
+                for (unsigned ix = 0; ix < _workers; ++ix) work(ix);
+            }
+        };
+
+    }
+}
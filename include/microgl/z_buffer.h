@@ -14,6 +14,17 @@
 #include "traits.h"
 
 namespace microgl {
+    /**
+     * a depth buffer, a depth passes the test if it is not greater than the depth of the pixel.
+     * the buffer also keeps the max depth of every tile of (tile_size x tile_size) pixels, so
+     * whole tiles and triangles, that are behind can be rejected before their pixels are
+     * tested. depths only get smaller by writes of tested pixels, so the max of a tile stays a
+     * bound and is computed again only when it was invalidated and is needed to reject.
+     * writes, that make a depth greater must be followed by invalidateTiles.
+     *
+     * @tparam Bits the bits of a depth value
+     * @tparam Allocator the allocator of the values
+     */
     template<unsigned Bits, class Allocator=microgl::traits::std_rebind_allocator<>>
     class z_buffer {
     private:
@@ -25,16 +36,53 @@ namespace microgl {
         using allocator_type = typename Allocator::template rebind<value_type>::other;
         static constexpr int bits = Bits;
         static constexpr value_type max_value = ~value_type(0);
+        static constexpr int tile_bits = 3, tile_size = 1<<tile_bits;
     private:
+        using flags_allocator_type = typename Allocator::template rebind<microgl::ints::uint8_t>::other;
         allocator_type _allocator;
+        flags_allocator_type _flags_allocator;
         value_type *_data = nullptr;
         int _w = 0, _h = 0, _size = 0;
+        int _tiles_w = 0, _tiles_h = 0;
+        value_type *_tiles = nullptr;
+        microgl::ints::uint8_t *_invalid = nullptr;
+
+        void updateTile(int tx, int ty) {
+            const int tile = ty * _tiles_w + tx;
+            const int left = tx << tile_bits, top = ty << tile_bits;
+            const int right = left + tile_size < _w ? left + tile_size : _w;
+            const int bottom = top + tile_size < _h ? top + tile_size : _h;
+            value_type max = 0;
+            for (int y = top; y < bottom; ++y) {
+                const value_type *row = _data + y * _w;
+                for (int x = left; x < right; ++x) if (row[x] > max) max = row[x];
+            }
+            _tiles[tile] = max;
+            _invalid[tile] = 0;
+        }
+        // clamp an inclusive rect of pixels to the tiles it overlaps
+        bool tilesOf(int &left, int &top, int &right, int &bottom) const {
+            left = left < 0 ? 0 : left; top = top < 0 ? 0 : top;
+            right = right >= _w ? _w - 1 : right; bottom = bottom >= _h ? _h - 1 : bottom;
+            if (left > right || top > bottom) return false;
+            left >>= tile_bits; top >>= tile_bits; right >>= tile_bits; bottom >>= tile_bits;
+            return true;
+        }
+
     public:
         explicit z_buffer(int w, int h, const Allocator &allocator = Allocator()) :
-                _allocator(allocator), _data(_allocator.allocate(w * h)), _w{w}, _h{w}, _size{w * h} {
+                _allocator(allocator), _flags_allocator(allocator), _data(_allocator.allocate(w * h)),
+                _w{w}, _h{h}, _size{w * h},
+                _tiles_w{(w + tile_size - 1) >> tile_bits}, _tiles_h{(h + tile_size - 1) >> tile_bits} {
+            _tiles = _allocator.allocate(_tiles_w * _tiles_h);
+            _invalid = _flags_allocator.allocate(_tiles_w * _tiles_h);
             clear();
         }
-        ~z_buffer() { _allocator.deallocate(_data); }
+        ~z_buffer() {
+            _allocator.deallocate(_data);
+            _allocator.deallocate(_tiles);
+            _flags_allocator.deallocate(_invalid);
+        }
         int width() const { return _w; }
         int height() const { return _h; }
         int size() const { return _size; }
@@ -45,7 +93,38 @@ namespace microgl {
         value_type &operator()(int x, int y) { return _data[y * _w + x]; }
         constexpr int maxValue() const { return max_value; }
         value_type *data() { return _data; }
-        void fill(const int &value) { for (int ix = 0; ix < _size; ++ix) _data[ix] = value; }
+        void fill(const int &value) {
+            for (int ix = 0; ix < _size; ++ix) _data[ix] = value;
+            for (int ix = 0; ix < _tiles_w * _tiles_h; ++ix) { _tiles[ix] = value; _invalid[ix] = 0; }
+        }
         void clear() { fill(maxValue()); }
+
+        /**
+         * the max depth of the tiles, that overlap an inclusive rect of pixels, was written
+         * to, so it has to be computed again, when it is needed
+         */
+        void invalidateTiles(int left, int top, int right, int bottom) {
+            if (!tilesOf(left, top, right, bottom)) return;
+            for (int ty = top; ty <= bottom; ++ty)
+                for (int tx = left; tx <= right; ++tx) _invalid[ty * _tiles_w + tx] = 1;
+        }
+
+        /**
+         * is a depth behind every pixel of an inclusive rect of pixels, if so, every depth,
+         * that is not smaller fails the depth test in the rect
+         */
+        bool occluded(int left, int top, int right, int bottom, value_type depth) {
+            if (!tilesOf(left, top, right, bottom)) return false;
+            for (int ty = top; ty <= bottom; ++ty) {
+                for (int tx = left; tx <= right; ++tx) {
+                    const int tile = ty * _tiles_w + tx;
+                    if (_tiles[tile] < depth) continue;
+                    if (!_invalid[tile]) return false;
+                    updateTile(tx, ty);
+                    if (_tiles[tile] >= depth) return false;
+                }
+            }
+            return true;
+        }
     };
-}
\ No newline at end of file
+}